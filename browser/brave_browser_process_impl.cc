@@ -325,8 +325,10 @@ brave::BraveP3AService* BraveBrowserProcessImpl::brave_p3a_service() {
   if (brave_p3a_service_) {
     return brave_p3a_service_.get();
   }
+  base::FilePath user_data_dir;
+  base::PathService::Get(chrome::DIR_USER_DATA, &user_data_dir);
   brave_p3a_service_ = base::MakeRefCounted<brave::BraveP3AService>(
-      local_state(), brave::GetChannelName(),
+      local_state(), user_data_dir, brave::GetChannelName(),
       local_state()->GetString(kWeekOfInstallation));
   brave_p3a_service()->InitCallbacks();
   return brave_p3a_service_.get();
@@ -5,20 +5,31 @@
 
 #include "brave/browser/net/brave_ad_block_tp_network_delegate_helper.h"
 
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "base/base64url.h"
+#include "base/containers/mru_cache.h"
 #include "base/feature_list.h"
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "base/metrics/histogram_macros.h"
+#include "base/no_destructor.h"
 #include "base/strings/string_util.h"
+#include "base/supports_user_data.h"
+#include "base/time/time.h"
 #include "brave/browser/brave_browser_process.h"
 #include "brave/browser/brave_shields/brave_shields_web_contents_observer.h"
 #include "brave/browser/net/url_context.h"
 #include "brave/common/network_constants.h"
 #include "brave/common/url_constants.h"
+#include "brave/components/brave_shields/browser/ad_block_engine.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
+#include "brave/components/brave_shields/browser/registrable_domain_cache.h"
 #include "brave/components/brave_shields/common/brave_shield_constants.h"
 #include "brave/components/brave_shields/common/features.h"
 #include "brave/grit/brave_generated_resources.h"
@@ -32,10 +43,10 @@
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/render_frame_host.h"
 #include "content/public/browser/storage_partition.h"
-#include "content/public/browser/web_contents.h"
 #include "content/public/common/url_constants.h"
 #include "extensions/common/url_pattern.h"
 #include "mojo/public/cpp/bindings/remote.h"
+#include "net/base/network_change_notifier.h"
 #include "net/proxy_resolution/proxy_config.h"
 #include "net/proxy_resolution/proxy_config_service.h"
 #include "net/proxy_resolution/proxy_config_with_annotation.h"
@@ -49,11 +60,6 @@ namespace brave {
 
 network::HostResolver* g_testing_host_resolver;
 
-void SetAdblockCnameHostResolverForTesting(
-    network::HostResolver* host_resolver) {
-  g_testing_host_resolver = host_resolver;
-}
-
 // Used to keep track of state between a primary adblock engine query and one
 // after CNAME uncloaking the request.
 struct EngineFlags {
@@ -62,6 +68,193 @@ struct EngineFlags {
   bool did_match_important = false;
 };
 
+namespace {
+
+// Resolutions are cached for a fixed time, since resolve host clients aren't
+// given the TTL of the records. The network stack's host cache still honors
+// the TTL for the resolutions themselves.
+constexpr base::TimeDelta kCnameCacheTtl = base::TimeDelta::FromMinutes(1);
+constexpr size_t kCnameCacheSize = 256;
+
+const char kCnameCacheUserDataKey[] = "brave_cname_cache";
+
+using CnameCallback = base::OnceCallback<void(absl::optional<std::string>)>;
+// Run with whether the resolution succeeded and can be cached
+using ResolvedCallback =
+    base::OnceCallback<void(bool, absl::optional<std::string>)>;
+
+// Logged to Brave.ShieldsCNAMEBlocking.CacheResult. Do not renumber.
+enum class CnameCacheResult {
+  kHit = 0,
+  // Joined a resolution already in flight for the same host
+  kCoalesced = 1,
+  kMiss = 2,
+  kMaxValue = kMiss,
+};
+
+// Canonical names resolved through the network context of one browser
+// context, keyed by host and network isolation key, along with the requests
+// waiting on resolutions in flight. Results are dropped when the DNS
+// configuration changes. Only used on the UI thread.
+class CnameCache : public base::SupportsUserData::Data,
+                   public net::NetworkChangeNotifier::DNSObserver {
+ public:
+  using Key = std::pair<std::string, net::NetworkIsolationKey>;
+
+  CnameCache() : entries_(kCnameCacheSize) {
+    net::NetworkChangeNotifier::AddDNSObserver(this);
+    GetAll().insert(this);
+  }
+
+  ~CnameCache() override {
+    GetAll().erase(this);
+    net::NetworkChangeNotifier::RemoveDNSObserver(this);
+  }
+
+  // Every live cache, so that they can all be cleared for tests
+  static std::set<CnameCache*>& GetAll() {
+    static base::NoDestructor<std::set<CnameCache*>> caches;
+    return *caches;
+  }
+
+  // Returns the cache of |browser_context|, which is destroyed with it
+  static CnameCache* FromBrowserContext(
+      content::BrowserContext* browser_context) {
+    DCHECK(!browser_context->IsOffTheRecord());
+    auto* cache = static_cast<CnameCache*>(
+        browser_context->GetUserData(kCnameCacheUserDataKey));
+    if (!cache) {
+      auto new_cache = std::make_unique<CnameCache>();
+      cache = new_cache.get();
+      browser_context->SetUserData(kCnameCacheUserDataKey,
+                                   std::move(new_cache));
+    }
+    return cache;
+  }
+
+  // Drops the cached results if secure DNS was configured differently when
+  // they were resolved
+  void UpdateSecureDnsConfig(const SecureDnsConfig& secure_dns_config) {
+    if (secure_dns_mode_ == secure_dns_config.mode() &&
+        secure_dns_servers_ == secure_dns_config.servers()) {
+      return;
+    }
+
+    secure_dns_mode_ = secure_dns_config.mode();
+    secure_dns_servers_ = secure_dns_config.servers();
+    Clear();
+  }
+
+  // Returns true and sets |cname| if a result for |key| hasn't expired
+  bool Get(const Key& key, absl::optional<std::string>* cname) {
+    auto it = entries_.Get(key);
+    if (it == entries_.end()) {
+      return false;
+    }
+
+    if (base::TimeTicks::Now() >= it->second.expiry) {
+      entries_.Erase(it);
+      return false;
+    }
+
+    *cname = it->second.cname;
+    return true;
+  }
+
+  // Returns true if a resolution for |key| under the current DNS
+  // configuration was already in flight, in which case |callback| runs when it
+  // completes. Otherwise the resolution must be started with
+  // |GetResolvedCallback|.
+  bool AddPending(const Key& key, CnameCallback callback) {
+    const PendingKey pending_key(key, generation_);
+    auto it = pending_.find(pending_key);
+    const bool in_flight = it != pending_.end();
+    pending_[pending_key].push_back(std::move(callback));
+    return in_flight;
+  }
+
+  ResolvedCallback GetResolvedCallback(const Key& key) {
+    return base::BindOnce(&CnameCache::OnResolved, weak_factory_.GetWeakPtr(),
+                          PendingKey(key, generation_));
+  }
+
+  // Drops the cached results and the requests waiting on resolutions in
+  // flight, which run without a canonical name
+  void ClearForTesting() {
+    Clear();
+    std::map<PendingKey, std::vector<CnameCallback>> pending;
+    pending.swap(pending_);
+    for (auto& it : pending) {
+      for (auto& callback : it.second) {
+        std::move(callback).Run(absl::nullopt);
+      }
+    }
+  }
+
+  // net::NetworkChangeNotifier::DNSObserver:
+  void OnDNSChanged() override { Clear(); }
+
+ private:
+  // Resolutions in flight are also keyed by the DNS configuration they were
+  // started under, so that requests don't join them once it changed
+  using PendingKey = std::pair<Key, int>;
+
+  struct Entry {
+    absl::optional<std::string> cname;
+    base::TimeTicks expiry;
+  };
+
+  void OnResolved(const PendingKey& pending_key,
+                  bool cacheable,
+                  absl::optional<std::string> cname) {
+    if (cacheable && pending_key.second == generation_) {
+      entries_.Put(pending_key.first,
+                   Entry{cname, base::TimeTicks::Now() + kCnameCacheTtl});
+    }
+
+    auto it = pending_.find(pending_key);
+    if (it == pending_.end()) {
+      return;
+    }
+
+    std::vector<CnameCallback> callbacks = std::move(it->second);
+    pending_.erase(it);
+    for (auto& callback : callbacks) {
+      std::move(callback).Run(cname);
+    }
+  }
+
+  void Clear() {
+    entries_.Clear();
+    generation_++;
+  }
+
+  base::MRUCache<Key, Entry> entries_;
+  std::map<PendingKey, std::vector<CnameCallback>> pending_;
+
+  // Incremented whenever the DNS configuration changes
+  int generation_ = 0;
+  absl::optional<net::SecureDnsMode> secure_dns_mode_;
+  std::vector<net::DnsOverHttpsServerConfig> secure_dns_servers_;
+
+  base::WeakPtrFactory<CnameCache> weak_factory_{this};
+
+  DISALLOW_COPY_AND_ASSIGN(CnameCache);
+};
+
+}  // namespace
+
+void SetAdblockCnameHostResolverForTesting(
+    network::HostResolver* host_resolver) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  g_testing_host_resolver = host_resolver;
+
+  // Results from the previous resolver must not leak into later tests
+  for (CnameCache* cache : CnameCache::GetAll()) {
+    cache->ClearForTesting();
+  }
+}
+
 void UseCnameResult(scoped_refptr<base::SequencedTaskRunner> task_runner,
                     const ResponseCallback& next_callback,
                     std::shared_ptr<BraveRequestInfo> ctx,
@@ -71,28 +264,26 @@ void UseCnameResult(scoped_refptr<base::SequencedTaskRunner> task_runner,
 class AdblockCnameResolveHostClient : public network::mojom::ResolveHostClient {
  private:
   mojo::Receiver<network::mojom::ResolveHostClient> receiver_{this};
-  base::OnceCallback<void(absl::optional<std::string>)> cb_;
+  ResolvedCallback callback_;
   base::TimeTicks start_time_;
 
  public:
+  // Resolves |host| through the network context of |browser_context|, which
+  // owns the cache the result is stored in.
   AdblockCnameResolveHostClient(
-      const ResponseCallback& next_callback,
-      scoped_refptr<base::SequencedTaskRunner> task_runner,
-      std::shared_ptr<BraveRequestInfo> ctx,
-      EngineFlags previous_result) {
+      content::BrowserContext* browser_context,
+      const net::HostPortPair& host,
+      const net::NetworkIsolationKey& network_isolation_key,
+      const SecureDnsConfig& secure_dns_config,
+      ResolvedCallback callback)
+      : callback_(std::move(callback)) {
     DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
-    cb_ = base::BindOnce(&UseCnameResult, task_runner, std::move(next_callback),
-                         ctx, previous_result);
-
-    const auto network_isolation_key = ctx->network_isolation_key;
+    DCHECK(browser_context);
 
     network::mojom::ResolveHostParametersPtr optional_parameters =
         network::mojom::ResolveHostParameters::New();
     optional_parameters->include_canonical_name = true;
 
-    SecureDnsConfig secure_dns_config =
-        SystemNetworkContextManager::GetStubResolverConfigReader()
-            ->GetSecureDnsConfiguration(false);
     // Explicitly specify source when DNS over HTTPS is enabled to avoid
     // using `HostResolverProc` which will be handled by system resolver
     // See https://crbug.com/872665
@@ -103,26 +294,15 @@ class AdblockCnameResolveHostClient : public network::mojom::ResolveHostClient {
 
     if (g_testing_host_resolver) {
       g_testing_host_resolver->ResolveHost(
-          net::HostPortPair::FromURL(ctx->request_url), network_isolation_key,
-          std::move(optional_parameters), receiver_.BindNewPipeAndPassRemote());
+          host, network_isolation_key, std::move(optional_parameters),
+          receiver_.BindNewPipeAndPassRemote());
     } else {
-      auto* web_contents =
-          content::WebContents::FromFrameTreeNodeId(ctx->frame_tree_node_id);
-      if (!web_contents) {
-        start_time_ = base::TimeTicks::Now();
-        this->OnComplete(net::ERR_FAILED, net::ResolveErrorInfo(),
-                         absl::nullopt);
-        return;
-      }
-
       network::mojom::NetworkContext* network_context =
-          web_contents->GetBrowserContext()
-              ->GetDefaultStoragePartition()
-              ->GetNetworkContext();
+          browser_context->GetDefaultStoragePartition()->GetNetworkContext();
 
       network_context->ResolveHost(
-          net::HostPortPair::FromURL(ctx->request_url), network_isolation_key,
-          std::move(optional_parameters), receiver_.BindNewPipeAndPassRemote());
+          host, network_isolation_key, std::move(optional_parameters),
+          receiver_.BindNewPipeAndPassRemote());
     }
 
     receiver_.set_disconnect_handler(
@@ -139,10 +319,11 @@ class AdblockCnameResolveHostClient : public network::mojom::ResolveHostClient {
                         base::TimeTicks::Now() - start_time_);
     if (result == net::OK && resolved_addresses) {
       DCHECK(resolved_addresses.has_value() && !resolved_addresses->empty());
-      std::move(cb_).Run(
+      std::move(callback_).Run(
+          true,
           absl::optional<std::string>(resolved_addresses->GetCanonicalName()));
     } else {
-      std::move(cb_).Run(absl::nullopt);
+      std::move(callback_).Run(result == net::OK, absl::nullopt);
     }
 
     delete this;
@@ -159,28 +340,88 @@ class AdblockCnameResolveHostClient : public network::mojom::ResolveHostClient {
   }
 };
 
-// If `canonical_url` is specified, this will only check if the CNAME-uncloaked
-// response should be blocked. Otherwise, it will run the check for the
-// original request URL.
+void OnCnameResolved(base::TimeTicks start_time,
+                     CnameCallback callback,
+                     absl::optional<std::string> cname) {
+  UMA_HISTOGRAM_TIMES("Brave.ShieldsCNAMEBlocking.AddedRequestLatency",
+                      base::TimeTicks::Now() - start_time);
+  std::move(callback).Run(std::move(cname));
+}
+
+// Runs |callback| with the canonical name of the request's host, from the
+// cache or by joining or starting a resolution. Off-the-record profiles don't
+// share resolutions, even among their own requests.
+void ResolveCname(std::shared_ptr<BraveRequestInfo> ctx,
+                  CnameCallback callback) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  DCHECK(ctx->browser_context);
+
+  const SecureDnsConfig secure_dns_config =
+      SystemNetworkContextManager::GetStubResolverConfigReader()
+          ->GetSecureDnsConfiguration(false);
+  CnameCallback on_resolved = base::BindOnce(
+      &OnCnameResolved, base::TimeTicks::Now(), std::move(callback));
+
+  if (ctx->browser_context->IsOffTheRecord()) {
+    // This will be deleted by `AdblockCnameResolveHostClient::OnComplete`.
+    new AdblockCnameResolveHostClient(
+        ctx->browser_context, net::HostPortPair::FromURL(ctx->request_url),
+        ctx->network_isolation_key, secure_dns_config,
+        base::BindOnce(
+            [](CnameCallback callback, bool cacheable,
+               absl::optional<std::string> cname) {
+              std::move(callback).Run(std::move(cname));
+            },
+            std::move(on_resolved)));
+    return;
+  }
+
+  CnameCache* cache = CnameCache::FromBrowserContext(ctx->browser_context);
+  cache->UpdateSecureDnsConfig(secure_dns_config);
+  const CnameCache::Key key(ctx->request_url.host(),
+                            ctx->network_isolation_key);
+
+  absl::optional<std::string> cname;
+  if (cache->Get(key, &cname)) {
+    UMA_HISTOGRAM_ENUMERATION("Brave.ShieldsCNAMEBlocking.CacheResult",
+                              CnameCacheResult::kHit);
+    std::move(on_resolved).Run(std::move(cname));
+    return;
+  }
+
+  if (cache->AddPending(key, std::move(on_resolved))) {
+    UMA_HISTOGRAM_ENUMERATION("Brave.ShieldsCNAMEBlocking.CacheResult",
+                              CnameCacheResult::kCoalesced);
+    return;
+  }
+
+  UMA_HISTOGRAM_ENUMERATION("Brave.ShieldsCNAMEBlocking.CacheResult",
+                            CnameCacheResult::kMiss);
+  // This will be deleted by `AdblockCnameResolveHostClient::OnComplete`.
+  new AdblockCnameResolveHostClient(
+      ctx->browser_context, net::HostPortPair::FromURL(ctx->request_url),
+      key.second, secure_dns_config, cache->GetResolvedCallback(key));
+}
+
+// `url_to_check` is either the original request URL or its CNAME-uncloaked
+// URL. `is_third_party` is computed by the caller on the UI thread, where the
+// memoized values of `ctx` can be used.
 EngineFlags ShouldBlockRequestOnTaskRunner(
     std::shared_ptr<BraveRequestInfo> ctx,
     EngineFlags previous_result,
-    absl::optional<GURL> canonical_url) {
+    const GURL& url_to_check,
+    bool is_third_party) {
   if (!ctx->initiator_url.is_valid()) {
     return previous_result;
   }
   const std::string source_host = ctx->initiator_url.host();
 
-  GURL url_to_check;
-  if (canonical_url.has_value()) {
-    url_to_check = *canonical_url;
-  } else {
-    url_to_check = ctx->request_url;
-  }
+  const brave_shields::AdBlockRequest request(url_to_check, ctx->resource_type,
+                                              source_host, is_third_party);
 
   g_brave_browser_process->ad_block_service()->ShouldStartRequest(
-      url_to_check, ctx->resource_type, source_host,
-      &previous_result.did_match_rule, &previous_result.did_match_exception,
+      request, &previous_result.did_match_rule,
+      &previous_result.did_match_exception,
       &previous_result.did_match_important, &ctx->mock_data_url);
 
   if (previous_result.did_match_important ||
@@ -203,9 +444,8 @@ void OnShouldBlockRequestResult(
     brave_shields::BraveShieldsWebContentsObserver::DispatchBlockedEvent(
         ctx->request_url, ctx->frame_tree_node_id, brave_shields::kAds);
   } else if (then_check_uncloaked) {
-    // This will be deleted by `AdblockCnameResolveHostClient::OnComplete`.
-    new AdblockCnameResolveHostClient(std::move(next_callback), task_runner,
-                                      ctx, result);
+    ResolveCname(ctx, base::BindOnce(&UseCnameResult, task_runner,
+                                     next_callback, ctx, result));
     return;
   }
   next_callback.Run();
@@ -224,11 +464,13 @@ void UseCnameResult(scoped_refptr<base::SequencedTaskRunner> task_runner,
     replacements.SetHost(cname->c_str(),
                          url::Component(0, static_cast<int>(cname->length())));
     const GURL canonical_url = ctx->request_url.ReplaceComponents(replacements);
+    const bool is_third_party = !brave_shields::SameRegistrableDomainOrHost(
+        canonical_url.host(), ctx->initiator_url.host());
 
     task_runner->PostTaskAndReplyWithResult(
         FROM_HERE,
         base::BindOnce(&ShouldBlockRequestOnTaskRunner, ctx, previous_result,
-                       absl::make_optional<GURL>(canonical_url)),
+                       canonical_url, is_third_party),
         base::BindOnce(&OnShouldBlockRequestResult, false, task_runner,
                        next_callback, ctx));
   } else {
@@ -293,7 +535,7 @@ void OnBeforeURLRequestAdBlockTP(const ResponseCallback& next_callback,
   task_runner->PostTaskAndReplyWithResult(
       FROM_HERE,
       base::BindOnce(&ShouldBlockRequestOnTaskRunner, ctx, EngineFlags(),
-                     absl::nullopt),
+                     ctx->request_url, ctx->IsThirdPartyToInitiator()),
       base::BindOnce(&OnShouldBlockRequestResult, should_check_uncloaked,
                      task_runner, next_callback, ctx));
 }
@@ -21,7 +21,8 @@ int OnBeforeURLRequest_AdBlockTPPreWork(
     std::shared_ptr<BraveRequestInfo> ctx);
 
 // Be sure to reset this to `nullptr` when done testing to prevent future tests
-// from being affected.
+// from being affected. Also drops the canonical names cached for every
+// profile, along with the requests waiting on resolutions in flight.
 void SetAdblockCnameHostResolverForTesting(
     network::HostResolver* host_resolver);
 
@@ -10,11 +10,20 @@
 #include <utility>
 
 #include "base/threading/thread_task_runner_handle.h"
+#include "base/time/time.h"
 #include "brave/browser/brave_browser_process.h"
 #include "brave/browser/net/url_context.h"
 #include "brave/common/network_constants.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
 #include "brave/test/base/testing_brave_browser_process.h"
+#include "chrome/browser/net/secure_dns_config.h"
+#include "chrome/browser/net/stub_resolver_config_reader.h"
+#include "chrome/browser/net/system_network_context_manager.h"
+#include "chrome/common/pref_names.h"
+#include "chrome/test/base/scoped_testing_local_state.h"
+#include "chrome/test/base/testing_browser_process.h"
+#include "chrome/test/base/testing_profile.h"
+#include "components/prefs/testing_pref_service.h"
 #include "content/public/test/browser_task_environment.h"
 #include "net/base/net_errors.h"
 #include "net/dns/mock_host_resolver.h"
@@ -116,11 +125,10 @@ class BraveAdBlockTPNetworkDelegateHelperTest : public testing::Test {
   std::unique_ptr<TestingBraveComponentUpdaterDelegate>
       brave_component_updater_delegate_;
 
-  content::BrowserTaskEnvironment task_environment_;
+  content::BrowserTaskEnvironment task_environment_{
+      base::test::TaskEnvironment::TimeSource::MOCK_TIME};
 
   std::unique_ptr<net::MockHostResolver> host_resolver_;
-
- private:
   std::unique_ptr<network::HostResolver> resolver_wrapper_;
 };
 
@@ -173,3 +181,146 @@ TEST_F(BraveAdBlockTPNetworkDelegateHelperTest, SimpleBlocking) {
   // made (`browser_context` is `nullptr`).
   EXPECT_EQ(0ULL, host_resolver_->num_resolve());
 }
+
+// Checks the CNAME uncloaking of first-party requests to a host that is
+// cloaked behind a blocked tracker.
+class BraveAdBlockTPCnameCacheTest
+    : public BraveAdBlockTPNetworkDelegateHelperTest {
+ protected:
+  void SetUp() override {
+    BraveAdBlockTPNetworkDelegateHelperTest::SetUp();
+
+    local_state_ = std::make_unique<ScopedTestingLocalState>(
+        TestingBrowserProcess::GetGlobal());
+    stub_resolver_config_reader_ =
+        std::make_unique<StubResolverConfigReader>(local_state_->Get());
+    SystemNetworkContextManager::set_stub_resolver_config_reader_for_testing(
+        stub_resolver_config_reader_.get());
+    profile_ = std::make_unique<TestingProfile>();
+
+    ResetAdblockInstance(g_brave_browser_process->ad_block_service(),
+                         "||tracker.com^", "");
+    host_resolver_->rules()->AddIPLiteralRuleWithDnsAliases(
+        "cloaked.example.com", "127.0.0.1", {"cname.tracker.com"});
+  }
+
+  void TearDown() override {
+    profile_.reset();
+    SystemNetworkContextManager::set_stub_resolver_config_reader_for_testing(
+        nullptr);
+    stub_resolver_config_reader_.reset();
+    local_state_.reset();
+    BraveAdBlockTPNetworkDelegateHelperTest::TearDown();
+  }
+
+  std::shared_ptr<brave::BraveRequestInfo> CheckCloakedRequest(
+      content::BrowserContext* browser_context) {
+    auto request_info = std::make_shared<brave::BraveRequestInfo>(
+        GURL("https://cloaked.example.com/script.js"));
+    request_info->resource_type = blink::mojom::ResourceType::kScript;
+    request_info->initiator_url = GURL("https://example.com");
+    request_info->browser_context = browser_context;
+
+    EXPECT_TRUE(CheckRequest(request_info));
+    return request_info;
+  }
+
+  std::unique_ptr<ScopedTestingLocalState> local_state_;
+  std::unique_ptr<StubResolverConfigReader> stub_resolver_config_reader_;
+  std::unique_ptr<TestingProfile> profile_;
+};
+
+TEST_F(BraveAdBlockTPCnameCacheTest, ReusesResolution) {
+  EXPECT_EQ(CheckCloakedRequest(profile_.get())->blocked_by,
+            brave::kAdBlocked);
+  EXPECT_EQ(1ULL, host_resolver_->num_resolve());
+
+  EXPECT_EQ(CheckCloakedRequest(profile_.get())->blocked_by,
+            brave::kAdBlocked);
+  EXPECT_EQ(1ULL, host_resolver_->num_resolve());
+}
+
+TEST_F(BraveAdBlockTPCnameCacheTest, CoalescesResolutionsInFlight) {
+  host_resolver_->set_ondemand_mode(true);
+
+  auto first = CheckCloakedRequest(profile_.get());
+  auto second = CheckCloakedRequest(profile_.get());
+  EXPECT_EQ(1ULL, host_resolver_->num_resolve());
+  EXPECT_EQ(first->blocked_by, brave::kNotBlocked);
+  EXPECT_EQ(second->blocked_by, brave::kNotBlocked);
+
+  host_resolver_->ResolveAllPending();
+  task_environment_.RunUntilIdle();
+
+  EXPECT_EQ(1ULL, host_resolver_->num_resolve());
+  EXPECT_EQ(first->blocked_by, brave::kAdBlocked);
+  EXPECT_EQ(second->blocked_by, brave::kAdBlocked);
+}
+
+TEST_F(BraveAdBlockTPCnameCacheTest, ResolutionsExpire) {
+  CheckCloakedRequest(profile_.get());
+  EXPECT_EQ(1ULL, host_resolver_->num_resolve());
+
+  task_environment_.FastForwardBy(base::TimeDelta::FromSeconds(59));
+  CheckCloakedRequest(profile_.get());
+  EXPECT_EQ(1ULL, host_resolver_->num_resolve());
+
+  // Resolutions are cached for a minute
+  task_environment_.FastForwardBy(base::TimeDelta::FromSeconds(1));
+  EXPECT_EQ(CheckCloakedRequest(profile_.get())->blocked_by,
+            brave::kAdBlocked);
+  EXPECT_EQ(2ULL, host_resolver_->num_resolve());
+}
+
+TEST_F(BraveAdBlockTPCnameCacheTest, ClearedOnSecureDnsChange) {
+  CheckCloakedRequest(profile_.get());
+  EXPECT_EQ(1ULL, host_resolver_->num_resolve());
+
+  local_state_->Get()->SetString(
+      prefs::kDnsOverHttpsMode,
+      SecureDnsConfig::ModeToString(net::SecureDnsMode::kAutomatic));
+  local_state_->Get()->SetString(prefs::kDnsOverHttpsTemplates,
+                                 "https://dns.example.com/dns-query{?dns}");
+
+  EXPECT_EQ(CheckCloakedRequest(profile_.get())->blocked_by,
+            brave::kAdBlocked);
+  EXPECT_EQ(2ULL, host_resolver_->num_resolve());
+
+  CheckCloakedRequest(profile_.get());
+  EXPECT_EQ(2ULL, host_resolver_->num_resolve());
+}
+
+TEST_F(BraveAdBlockTPCnameCacheTest, ClearedWithTestingHostResolver) {
+  CheckCloakedRequest(profile_.get());
+  EXPECT_EQ(1ULL, host_resolver_->num_resolve());
+
+  brave::SetAdblockCnameHostResolverForTesting(resolver_wrapper_.get());
+
+  CheckCloakedRequest(profile_.get());
+  EXPECT_EQ(2ULL, host_resolver_->num_resolve());
+}
+
+TEST_F(BraveAdBlockTPCnameCacheTest, OffTheRecordBypassesCache) {
+  content::BrowserContext* otr_profile =
+      profile_->GetPrimaryOTRProfile(/*create_if_needed=*/true);
+  host_resolver_->set_ondemand_mode(true);
+
+  // Resolutions in flight aren't joined
+  auto first = CheckCloakedRequest(otr_profile);
+  auto second = CheckCloakedRequest(otr_profile);
+  EXPECT_EQ(2ULL, host_resolver_->num_resolve());
+
+  host_resolver_->ResolveAllPending();
+  task_environment_.RunUntilIdle();
+  EXPECT_EQ(first->blocked_by, brave::kAdBlocked);
+  EXPECT_EQ(second->blocked_by, brave::kAdBlocked);
+
+  // Nor are completed ones reused
+  host_resolver_->set_ondemand_mode(false);
+  CheckCloakedRequest(otr_profile);
+  EXPECT_EQ(3ULL, host_resolver_->num_resolve());
+
+  // And a regular profile doesn't see them
+  CheckCloakedRequest(profile_.get());
+  EXPECT_EQ(4ULL, host_resolver_->num_resolve());
+}
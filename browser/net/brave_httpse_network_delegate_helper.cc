@@ -8,6 +8,7 @@
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "base/task/post_task.h"
 #include "base/threading/scoped_blocking_call.h"
@@ -23,6 +24,63 @@ using content::BrowserThread;
 
 namespace brave {
 
+namespace {
+
+bool CanUpgradeRequest(std::shared_ptr<BraveRequestInfo> ctx) {
+  if (ctx->tab_origin.is_empty() || ctx->allow_http_upgradable_resource ||
+      !ctx->allow_brave_shields) {
+    return false;
+  }
+
+  bool is_valid_url = true;
+  is_valid_url = ctx->request_url.is_valid();
+  std::string scheme = ctx->request_url.scheme();
+  if (scheme.length()) {
+    std::transform(scheme.begin(), scheme.end(), scheme.begin(), ::tolower);
+    if ("http" != scheme && "https" != scheme) {
+      is_valid_url = false;
+    }
+  }
+
+  return is_valid_url;
+}
+
+void HttpsePrefetchFileWork(const GURL& request_url,
+                            std::shared_ptr<HttpseLookup> lookup) {
+  base::ScopedBlockingCall scoped_blocking_call(FROM_HERE,
+                                                base::BlockingType::WILL_BLOCK);
+  g_brave_browser_process->https_everywhere_service()->LookupHTTPSURL(
+      &request_url, &lookup->new_url_spec);
+}
+
+void OnHttpsePrefetchDone(std::shared_ptr<HttpseLookup> lookup) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+
+  lookup->done = true;
+  if (lookup->on_done) {
+    std::move(lookup->on_done).Run(lookup->new_url_spec);
+  }
+}
+
+// Applies an upgrade found by |OnBeforeURLRequest_HttpsePrefetch|. The
+// prefetch doesn't count it as a redirect of the request, since an earlier
+// stage may have set a new URL, so it is counted here.
+void ApplyHttpseLookup(std::shared_ptr<BraveRequestInfo> ctx,
+                       const std::string& new_url_spec) {
+  if (new_url_spec.empty() ||
+      !g_brave_browser_process->https_everywhere_service()
+           ->RecordHTTPSERedirect(ctx->request_identifier)) {
+    return;
+  }
+  ctx->new_url_spec = new_url_spec;
+}
+
+}  // namespace
+
+HttpseLookup::HttpseLookup() = default;
+
+HttpseLookup::~HttpseLookup() = default;
+
 void OnBeforeURLRequest_HttpseFileWork(std::shared_ptr<BraveRequestInfo> ctx) {
   base::ScopedBlockingCall scoped_blocking_call(FROM_HERE,
                                                 base::BlockingType::WILL_BLOCK);
@@ -46,51 +104,89 @@ void OnBeforeURLRequest_HttpsePostFileWork(
   next_callback.Run();
 }
 
+void OnBeforeURLRequest_HttpsePrefetchDone(
+    const ResponseCallback& next_callback,
+    std::shared_ptr<BraveRequestInfo> ctx,
+    const std::string& new_url_spec) {
+  ApplyHttpseLookup(ctx, new_url_spec);
+  OnBeforeURLRequest_HttpsePostFileWork(next_callback, ctx);
+}
+
+void OnBeforeURLRequest_HttpsePrefetch(std::shared_ptr<BraveRequestInfo> ctx) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+
+  if (!CanUpgradeRequest(ctx)) {
+    return;
+  }
+
+  auto lookup = std::make_shared<HttpseLookup>();
+  ctx->httpse_lookup = lookup;
+
+  if (g_brave_browser_process->https_everywhere_service()
+          ->LookupHTTPSURLFromCacheOnly(&ctx->request_url,
+                                        &lookup->new_url_spec)) {
+    lookup->done = true;
+    return;
+  }
+
+  g_brave_browser_process->https_everywhere_service()
+      ->GetTaskRunner()
+      ->PostTaskAndReply(
+          FROM_HERE,
+          base::BindOnce(&HttpsePrefetchFileWork, ctx->request_url, lookup),
+          base::BindOnce(&OnHttpsePrefetchDone, lookup));
+}
+
 int OnBeforeURLRequest_HttpsePreFileWork(
     const ResponseCallback& next_callback,
     std::shared_ptr<BraveRequestInfo> ctx) {
   DCHECK_CURRENTLY_ON(BrowserThread::UI);
 
+  std::shared_ptr<HttpseLookup> lookup = std::move(ctx->httpse_lookup);
+
   // Don't try to overwrite an already set URL by another delegate (adblock/tp)
   if (!ctx->new_url_spec.empty()) {
     return net::OK;
   }
 
-  if (ctx->tab_origin.is_empty() || ctx->allow_http_upgradable_resource ||
-      !ctx->allow_brave_shields) {
+  if (!CanUpgradeRequest(ctx)) {
     return net::OK;
   }
 
-  bool is_valid_url = true;
-  is_valid_url = ctx->request_url.is_valid();
-  std::string scheme = ctx->request_url.scheme();
-  if (scheme.length()) {
-    std::transform(scheme.begin(), scheme.end(), scheme.begin(), ::tolower);
-    if ("http" != scheme && "https" != scheme) {
-      is_valid_url = false;
+  if (lookup) {
+    if (!lookup->done) {
+      lookup->on_done = base::BindOnce(&OnBeforeURLRequest_HttpsePrefetchDone,
+                                       next_callback, ctx);
+      return net::ERR_IO_PENDING;
     }
-  }
 
-  if (is_valid_url) {
-    if (!g_brave_browser_process->https_everywhere_service()
-             ->GetHTTPSURLFromCacheOnly(&ctx->request_url,
-                                        ctx->request_identifier,
-                                        &ctx->new_url_spec)) {
-      g_brave_browser_process->https_everywhere_service()
-          ->GetTaskRunner()
-          ->PostTaskAndReply(
-              FROM_HERE, base::BindOnce(OnBeforeURLRequest_HttpseFileWork, ctx),
-              base::BindOnce(
-                  base::IgnoreResult(&OnBeforeURLRequest_HttpsePostFileWork),
-                  next_callback, ctx));
-      return net::ERR_IO_PENDING;
-    } else {
-      if (!ctx->new_url_spec.empty()) {
-        brave_shields::BraveShieldsWebContentsObserver::DispatchBlockedEvent(
-            ctx->request_url, ctx->frame_tree_node_id,
-            brave_shields::kHTTPUpgradableResources);
-      }
+    ApplyHttpseLookup(ctx, lookup->new_url_spec);
+    if (!ctx->new_url_spec.empty()) {
+      brave_shields::BraveShieldsWebContentsObserver::DispatchBlockedEvent(
+          ctx->request_url, ctx->frame_tree_node_id,
+          brave_shields::kHTTPUpgradableResources);
     }
+    return net::OK;
+  }
+
+  if (!g_brave_browser_process->https_everywhere_service()
+           ->GetHTTPSURLFromCacheOnly(&ctx->request_url,
+                                      ctx->request_identifier,
+                                      &ctx->new_url_spec)) {
+    g_brave_browser_process->https_everywhere_service()
+        ->GetTaskRunner()
+        ->PostTaskAndReply(
+            FROM_HERE, base::BindOnce(OnBeforeURLRequest_HttpseFileWork, ctx),
+            base::BindOnce(
+                base::IgnoreResult(&OnBeforeURLRequest_HttpsePostFileWork),
+                next_callback, ctx));
+    return net::ERR_IO_PENDING;
+  }
+
+  if (!ctx->new_url_spec.empty()) {
+    brave_shields::BraveShieldsWebContentsObserver::DispatchBlockedEvent(
+        ctx->request_url, ctx->frame_tree_node_id,
+        brave_shields::kHTTPUpgradableResources);
   }
 
   return net::OK;
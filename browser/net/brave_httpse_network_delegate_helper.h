@@ -5,10 +5,37 @@
 #ifndef BRAVE_BROWSER_NET_BRAVE_HTTPSE_NETWORK_DELEGATE_H_
 #define BRAVE_BROWSER_NET_BRAVE_HTTPSE_NETWORK_DELEGATE_H_
 
+#include <memory>
+#include <string>
+
+#include "base/callback.h"
+#include "base/macros.h"
 #include "brave/browser/net/url_context.h"
 
 namespace brave {
 
+// The result of an HTTPS Everywhere lookup started ahead of its stage.
+// Accessed on the UI thread, except for |new_url_spec| which is written on the
+// HTTPS Everywhere sequence until |done| is set.
+struct HttpseLookup {
+  HttpseLookup();
+  ~HttpseLookup();
+
+  bool done = false;
+  std::string new_url_spec;
+  // Run with |new_url_spec| once the lookup completes, if its stage was
+  // reached first
+  base::OnceCallback<void(const std::string&)> on_done;
+
+  DISALLOW_COPY_AND_ASSIGN(HttpseLookup);
+};
+
+// Starts the HTTPS Everywhere lookup for |ctx|, so that it runs concurrently
+// with the stages before |OnBeforeURLRequest_HttpsePreFileWork|, which merges
+// its result. The lookup has no effect on the request until merged, so it is
+// wasted but harmless when an earlier stage blocks or redirects the request.
+void OnBeforeURLRequest_HttpsePrefetch(std::shared_ptr<BraveRequestInfo> ctx);
+
 int OnBeforeURLRequest_HttpsePreFileWork(
     const ResponseCallback& next_callback,
     std::shared_ptr<BraveRequestInfo> ctx);
@@ -53,4 +53,54 @@ TEST_F(BraveHTTPSENetworkDelegateHelperTest, AlreadySetNewURLNoOp) {
   EXPECT_EQ(ret, net::OK);
 }
 
+TEST_F(BraveHTTPSENetworkDelegateHelperTest, AlreadySetNewURLDropsPrefetch) {
+  auto brave_request_info = std::make_shared<brave::BraveRequestInfo>(
+      GURL("http://bradhatesprimes.brave.com/composite_numbers_ftw"));
+  brave_request_info->tab_origin = GURL("http://brad.brave.com/");
+  brave_request_info->new_url_spec = "data:image/png;base64,iVB";
+  auto lookup = std::make_shared<brave::HttpseLookup>();
+  lookup->done = true;
+  lookup->new_url_spec =
+      "https://bradhatesprimes.brave.com/composite_numbers_ftw";
+  brave_request_info->httpse_lookup = lookup;
+
+  brave::ResponseCallback callback;
+  int ret =
+      OnBeforeURLRequest_HttpsePreFileWork(callback, brave_request_info);
+  EXPECT_EQ(ret, net::OK);
+  EXPECT_EQ(brave_request_info->new_url_spec, "data:image/png;base64,iVB");
+  EXPECT_FALSE(brave_request_info->httpse_lookup);
+}
+
+TEST_F(BraveHTTPSENetworkDelegateHelperTest, CompletedPrefetchWithoutUpgrade) {
+  auto brave_request_info = std::make_shared<brave::BraveRequestInfo>(
+      GURL("http://bradhatesprimes.brave.com/composite_numbers_ftw"));
+  brave_request_info->tab_origin = GURL("http://brad.brave.com/");
+  auto lookup = std::make_shared<brave::HttpseLookup>();
+  lookup->done = true;
+  brave_request_info->httpse_lookup = lookup;
+
+  brave::ResponseCallback callback;
+  int ret =
+      OnBeforeURLRequest_HttpsePreFileWork(callback, brave_request_info);
+  EXPECT_EQ(ret, net::OK);
+  EXPECT_TRUE(brave_request_info->new_url_spec.empty());
+  EXPECT_FALSE(brave_request_info->httpse_lookup);
+}
+
+TEST_F(BraveHTTPSENetworkDelegateHelperTest, PendingPrefetchWaits) {
+  auto brave_request_info = std::make_shared<brave::BraveRequestInfo>(
+      GURL("http://bradhatesprimes.brave.com/composite_numbers_ftw"));
+  brave_request_info->tab_origin = GURL("http://brad.brave.com/");
+  auto lookup = std::make_shared<brave::HttpseLookup>();
+  brave_request_info->httpse_lookup = lookup;
+
+  brave::ResponseCallback callback;
+  int ret =
+      OnBeforeURLRequest_HttpsePreFileWork(callback, brave_request_info);
+  EXPECT_EQ(ret, net::ERR_IO_PENDING);
+  EXPECT_TRUE(lookup->on_done);
+  EXPECT_FALSE(brave_request_info->httpse_lookup);
+}
+
 }  // namespace
@@ -6,10 +6,11 @@
 #include "brave/browser/net/brave_request_handler.h"
 
 #include <algorithm>
+#include <string>
 #include <utility>
 
 #include "base/feature_list.h"
-#include "base/metrics/histogram_macros.h"
+#include "base/metrics/histogram_functions.h"
 #include "base/task/post_task.h"
 #include "brave/browser/net/brave_ad_block_csp_network_delegate_helper.h"
 #include "brave/browser/net/brave_ad_block_tp_network_delegate_helper.h"
@@ -66,6 +67,17 @@ static bool IsInternalScheme(std::shared_ptr<brave::BraveRequestInfo> ctx) {
          ctx->request_url.SchemeIs(content::kChromeUIScheme);
 }
 
+BraveRequestHandler::BeforeURLRequestStage::BeforeURLRequestStage(
+    const std::string& name,
+    brave::OnBeforeURLRequestCallback callback)
+    : histogram_name("Brave.OnBeforeURLRequest." + name),
+      callback(callback) {}
+
+BraveRequestHandler::BeforeURLRequestStage::BeforeURLRequestStage(
+    const BeforeURLRequestStage& other) = default;
+
+BraveRequestHandler::BeforeURLRequestStage::~BeforeURLRequestStage() = default;
+
 BraveRequestHandler::BraveRequestHandler() {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
   SetupCallbacks();
@@ -73,42 +85,54 @@ BraveRequestHandler::BraveRequestHandler() {
 
 BraveRequestHandler::~BraveRequestHandler() = default;
 
+void BraveRequestHandler::AddBeforeURLRequestStage(
+    const std::string& name,
+    brave::OnBeforeURLRequestCallback callback) {
+  before_url_request_stages_.emplace_back(name, callback);
+}
+
 void BraveRequestHandler::SetupCallbacks() {
-  brave::OnBeforeURLRequestCallback callback =
-      base::BindRepeating(brave::OnBeforeURLRequest_SiteHacksWork);
-  before_url_request_callbacks_.push_back(callback);
+  AddBeforeURLRequestStage(
+      "SiteHacks",
+      base::BindRepeating(brave::OnBeforeURLRequest_SiteHacksWork));
 
-  callback = base::BindRepeating(brave::OnBeforeURLRequest_AdBlockTPPreWork);
-  before_url_request_callbacks_.push_back(callback);
+  AddBeforeURLRequestStage(
+      "AdBlockTP",
+      base::BindRepeating(brave::OnBeforeURLRequest_AdBlockTPPreWork));
 
-  callback = base::BindRepeating(brave::OnBeforeURLRequest_HttpsePreFileWork);
-  before_url_request_callbacks_.push_back(callback);
+  AddBeforeURLRequestStage(
+      "HTTPSE",
+      base::BindRepeating(brave::OnBeforeURLRequest_HttpsePreFileWork));
+  before_url_request_stages_.back().prefetch =
+      base::BindRepeating(brave::OnBeforeURLRequest_HttpsePrefetch);
 
-  callback =
-      base::BindRepeating(brave::OnBeforeURLRequest_CommonStaticRedirectWork);
-  before_url_request_callbacks_.push_back(callback);
+  AddBeforeURLRequestStage(
+      "CommonStaticRedirect",
+      base::BindRepeating(brave::OnBeforeURLRequest_CommonStaticRedirectWork));
 
 #if BUILDFLAG(DECENTRALIZED_DNS_ENABLED) && BUILDFLAG(BRAVE_WALLET_ENABLED)
-  callback = base::BindRepeating(
-      decentralized_dns::OnBeforeURLRequest_DecentralizedDnsPreRedirectWork);
-  before_url_request_callbacks_.push_back(callback);
+  brave::OnBeforeURLRequestCallback decentralized_dns_callback =
+      base::BindRepeating(
+          decentralized_dns::OnBeforeURLRequest_DecentralizedDnsPreRedirectWork);
+  AddBeforeURLRequestStage("DecentralizedDns", decentralized_dns_callback);
 #endif
 
 #if BUILDFLAG(BRAVE_REWARDS_ENABLED)
-  callback = base::BindRepeating(brave_rewards::OnBeforeURLRequest);
-  before_url_request_callbacks_.push_back(callback);
+  AddBeforeURLRequestStage(
+      "Rewards", base::BindRepeating(brave_rewards::OnBeforeURLRequest));
 #endif
 
 #if BUILDFLAG(ENABLE_BRAVE_TRANSLATE_GO)
-  callback =
-      base::BindRepeating(brave::OnBeforeURLRequest_TranslateRedirectWork);
-  before_url_request_callbacks_.push_back(callback);
+  AddBeforeURLRequestStage(
+      "TranslateRedirect",
+      base::BindRepeating(brave::OnBeforeURLRequest_TranslateRedirectWork));
 #endif
 
 #if BUILDFLAG(IPFS_ENABLED)
   if (base::FeatureList::IsEnabled(ipfs::features::kIpfsFeature)) {
-    callback = base::BindRepeating(ipfs::OnBeforeURLRequest_IPFSRedirectWork);
-    before_url_request_callbacks_.push_back(callback);
+    AddBeforeURLRequestStage(
+        "IPFSRedirect",
+        base::BindRepeating(ipfs::OnBeforeURLRequest_IPFSRedirectWork));
     brave::OnHeadersReceivedCallback ipfs_headers_received_callback =
         base::BindRepeating(ipfs::OnHeadersReceived_IPFSRedirectWork);
     headers_received_callbacks_.push_back(ipfs_headers_received_callback);
@@ -156,13 +180,17 @@ int BraveRequestHandler::OnBeforeURLRequest(
     std::shared_ptr<brave::BraveRequestInfo> ctx,
     net::CompletionOnceCallback callback,
     GURL* new_url) {
-  if (before_url_request_callbacks_.empty() || IsInternalScheme(ctx)) {
+  if (before_url_request_stages_.empty() || IsInternalScheme(ctx)) {
     return net::OK;
   }
-  SCOPED_UMA_HISTOGRAM_TIMER("Brave.OnBeforeURLRequest_Handler");
   ctx->new_url = new_url;
   ctx->event_type = brave::kOnBeforeRequest;
   callbacks_[ctx->request_identifier] = std::move(callback);
+  for (const auto& stage : before_url_request_stages_) {
+    if (stage.prefetch) {
+      stage.prefetch.Run(ctx);
+    }
+  }
   RunNextCallback(ctx);
   return net::ERR_IO_PENDING;
 }
@@ -219,20 +247,38 @@ void BraveRequestHandler::OnURLRequestDestroyed(
 void BraveRequestHandler::RunCallbackForRequestIdentifier(
     uint64_t request_identifier,
     int rv) {
-  std::map<uint64_t, net::CompletionOnceCallback>::iterator it =
-      callbacks_.find(request_identifier);
+  auto it = callbacks_.find(request_identifier);
   // We intentionally do the async call to maintain the proper flow
   // of URLLoader callbacks.
   base::PostTask(FROM_HERE, {content::BrowserThread::UI},
                  base::BindOnce(std::move(it->second), rv));
 }
 
+void BraveRequestHandler::RecordBeforeURLRequestStageTime(
+    std::shared_ptr<brave::BraveRequestInfo> ctx) {
+  if (ctx->stage_start_time.is_null()) {
+    return;
+  }
+
+  DCHECK_GT(ctx->next_url_request_index, 0u);
+  const BeforeURLRequestStage& stage =
+      before_url_request_stages_[ctx->next_url_request_index - 1];
+  base::UmaHistogramTimes(stage.histogram_name,
+                          base::TimeTicks::Now() - ctx->stage_start_time);
+  ctx->stage_start_time = base::TimeTicks();
+}
+
 // TODO(iefremov): Merge all callback containers into one and run only one loop
 // instead of many (issues/5574).
 void BraveRequestHandler::RunNextCallback(
     std::shared_ptr<brave::BraveRequestInfo> ctx) {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
 
+  if (ctx->event_type == brave::kOnBeforeRequest) {
+    // Completes the stage that returned PENDING, if any
+    RecordBeforeURLRequestStageTime(ctx);
+  }
+
   if (!base::Contains(callbacks_, ctx->request_identifier)) {
     return;
   }
@@ -241,17 +287,18 @@ void BraveRequestHandler::RunNextCallback(
   int rv = net::OK;
 
   if (ctx->event_type == brave::kOnBeforeRequest) {
-    while (before_url_request_callbacks_.size() !=
-           ctx->next_url_request_index) {
-      brave::OnBeforeURLRequestCallback callback =
-          before_url_request_callbacks_[ctx->next_url_request_index++];
+    while (before_url_request_stages_.size() != ctx->next_url_request_index) {
+      const BeforeURLRequestStage& stage =
+          before_url_request_stages_[ctx->next_url_request_index++];
       brave::ResponseCallback next_callback =
           base::BindRepeating(&BraveRequestHandler::RunNextCallback,
                               weak_factory_.GetWeakPtr(), ctx);
-      rv = callback.Run(next_callback, ctx);
+      ctx->stage_start_time = base::TimeTicks::Now();
+      rv = stage.callback.Run(next_callback, ctx);
       if (rv == net::ERR_IO_PENDING) {
         return;
       }
+      RecordBeforeURLRequestStageTime(ctx);
       if (rv != net::OK) {
         break;
       }
@@ -6,11 +6,11 @@
 #ifndef BRAVE_BROWSER_NET_BRAVE_REQUEST_HANDLER_H_
 #define BRAVE_BROWSER_NET_BRAVE_REQUEST_HANDLER_H_
 
-#include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "base/containers/flat_map.h"
 #include "brave/browser/net/url_context.h"
 #include "content/public/browser/browser_thread.h"
 #include "net/base/completion_once_callback.h"
@@ -44,15 +44,37 @@ class BraveRequestHandler {
   void RunCallbackForRequestIdentifier(uint64_t request_identifier, int rv);
 
  private:
+  // A stage of the |OnBeforeURLRequest| pipeline. Stages run in order and the
+  // first one to set a new URL wins. Pure stages are lookups that only read the
+  // request, so their work starts concurrently on a worker when the pipeline
+  // starts and the stage merges the result in its place in the order.
+  struct BeforeURLRequestStage {
+    BeforeURLRequestStage(const std::string& name,
+                          brave::OnBeforeURLRequestCallback callback);
+    BeforeURLRequestStage(const BeforeURLRequestStage& other);
+    ~BeforeURLRequestStage();
+
+    // Latency histogram for the stage
+    std::string histogram_name;
+    brave::OnBeforeURLRequestCallback callback;
+    // Starts the lookup of a pure stage, unset for other stages
+    base::RepeatingCallback<void(std::shared_ptr<brave::BraveRequestInfo>)>
+        prefetch;
+  };
+
   void SetupCallbacks();
+  void AddBeforeURLRequestStage(const std::string& name,
+                                brave::OnBeforeURLRequestCallback callback);
+  void RecordBeforeURLRequestStageTime(
+      std::shared_ptr<brave::BraveRequestInfo> ctx);
   void RunNextCallback(std::shared_ptr<brave::BraveRequestInfo> ctx);
 
-  std::vector<brave::OnBeforeURLRequestCallback> before_url_request_callbacks_;
+  std::vector<BeforeURLRequestStage> before_url_request_stages_;
   std::vector<brave::OnBeforeStartTransactionCallback>
       before_start_transaction_callbacks_;
   std::vector<brave::OnHeadersReceivedCallback> headers_received_callbacks_;
 
-  std::map<uint64_t, net::CompletionOnceCallback> callbacks_;
+  base::flat_map<uint64_t, net::CompletionOnceCallback> callbacks_;
 
   base::WeakPtrFactory<BraveRequestHandler> weak_factory_{this};
   DISALLOW_COPY_AND_ASSIGN(BraveRequestHandler);
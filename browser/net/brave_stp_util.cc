@@ -8,7 +8,7 @@
 #include <string>
 
 #include "base/no_destructor.h"
-#include "net/base/registry_controlled_domains/registry_controlled_domain.h"
+#include "brave/components/brave_shields/browser/registrable_domain_cache.h"
 
 namespace brave {
 
@@ -28,9 +28,8 @@ void RemoveTrackableSecurityHeadersForThirdParty(
     return;
   }
 
-  if (net::registry_controlled_domains::SameDomainOrHost(
-          request_url, top_frame_origin,
-          net::registry_controlled_domains::INCLUDE_PRIVATE_REGISTRIES)) {
+  if (brave_shields::SameRegistrableDomainOrHost(request_url.host(),
+                                                top_frame_origin.host())) {
     return;
   }
 
@@ -10,6 +10,7 @@
 
 #include "brave/browser/brave_shields/brave_shields_web_contents_observer.h"
 #include "brave/components/brave_shields/browser/brave_shields_util.h"
+#include "brave/components/brave_shields/browser/registrable_domain_cache.h"
 #include "brave/components/brave_webtorrent/browser/buildflags/buildflags.h"
 #include "brave/components/brave_webtorrent/browser/webtorrent_util.h"
 #include "brave/components/ipfs/buildflags/buildflags.h"
@@ -55,6 +56,34 @@ BraveRequestInfo::BraveRequestInfo(const GURL& url) : request_url(url) {}
 
 BraveRequestInfo::~BraveRequestInfo() = default;
 
+const std::string& BraveRequestInfo::GetRequestDomain() {
+  if (!request_domain_) {
+    request_domain_ = brave_shields::GetRegistrableDomain(request_url.host());
+  }
+  return *request_domain_;
+}
+
+bool BraveRequestInfo::IsThirdPartyToInitiator() {
+  if (!is_third_party_to_initiator_) {
+    is_third_party_to_initiator_ = !IsSameDomainOrHostAsRequest(initiator_url);
+  }
+  return *is_third_party_to_initiator_;
+}
+
+bool BraveRequestInfo::IsSameDomainOrHostAsRequest(const GURL& url) {
+  if (url.host_piece().empty() || request_url.host_piece().empty()) {
+    return false;
+  }
+
+  if (url.host_piece() == request_url.host_piece()) {
+    return true;
+  }
+
+  const std::string& request_domain = GetRequestDomain();
+  return !request_domain.empty() &&
+         request_domain == brave_shields::GetRegistrableDomain(url.host());
+}
+
 // static
 std::shared_ptr<brave::BraveRequestInfo> BraveRequestInfo::MakeCTX(
     const network::ResourceRequest& request,
@@ -10,6 +10,7 @@
 #include <set>
 #include <string>
 
+#include "base/time/time.h"
 #include "net/base/network_isolation_key.h"
 #include "net/http/http_request_headers.h"
 #include "net/http/http_response_headers.h"
@@ -30,6 +31,7 @@ struct ResourceRequest;
 
 namespace brave {
 struct BraveRequestInfo;
+struct HttpseLookup;
 using ResponseCallback = base::RepeatingCallback<void()>;
 }  // namespace brave
 
@@ -82,6 +84,8 @@ struct BraveRequestInfo {
   int frame_tree_node_id = 0;
   uint64_t request_identifier = 0;
   size_t next_url_request_index = 0;
+  // When the stage at |next_url_request_index| - 1 started, if it is running
+  base::TimeTicks stage_start_time;
 
   content::BrowserContext* browser_context = nullptr;
   net::HttpRequestHeaders* headers = nullptr;
@@ -98,9 +102,21 @@ struct BraveRequestInfo {
   std::string mock_data_url;
   GURL ipfs_gateway_url;
   bool ipfs_auto_fallback = false;
+  // Started by |OnBeforeURLRequest_HttpsePrefetch|
+  std::shared_ptr<HttpseLookup> httpse_lookup;
 
   bool ShouldMockRequest() const { return !mock_data_url.empty(); }
 
+  // The registrable domain of |request_url| and whether the request is
+  // third-party to |initiator_url| are computed once on first use and shared by
+  // every helper handling the request. They are only called on the UI thread,
+  // helpers pass the values on to other threads.
+  const std::string& GetRequestDomain();
+  bool IsThirdPartyToInitiator();
+  // Equivalent to SameDomainOrHost(|url|, |request_url|) with private
+  // registries, reusing the registrable domain of |request_url|
+  bool IsSameDomainOrHostAsRequest(const GURL& url);
+
   net::NetworkIsolationKey network_isolation_key = net::NetworkIsolationKey();
 
   // Default to invalid type for resource_type, so delegate helpers
@@ -128,6 +144,9 @@ struct BraveRequestInfo {
 
   GURL* new_url = nullptr;
 
+  absl::optional<std::string> request_domain_;
+  absl::optional<bool> is_third_party_to_initiator_;
+
   DISALLOW_COPY_AND_ASSIGN(BraveRequestInfo);
 };
 
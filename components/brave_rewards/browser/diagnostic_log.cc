@@ -5,21 +5,25 @@
 
 #include "brave/components/brave_rewards/browser/diagnostic_log.h"
 
-#include <memory>
 #include <utility>
 
-#include "base/files/file_util.h"
+#include "base/bind.h"
 #include "base/i18n/time_formatting.h"
 #include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/task/post_task.h"
 #include "base/task/thread_pool.h"
+#include "brave/components/brave_rewards/browser/diagnostic_log_segments.h"
 
 namespace {
 
-const int64_t kChunkSize = 1024;
 const size_t kDividerLength = 80;
 
+// Log entries are written at most this long after they are logged, or as
+// soon as this much has been buffered
+constexpr base::TimeDelta kFlushDelay = base::TimeDelta::FromSeconds(1);
+const size_t kMaxPendingSize = 64 * 1024;
+
 std::string FormatTime(const base::Time& time) {
   return base::UTF16ToUTF8(
       base::TimeFormatWithPattern(time, "MMM dd, YYYY h::mm::ss.S a"));
@@ -48,261 +52,32 @@ std::string GetLogVerboseLevelName(int verbose_level) {
   return verbose_level_name;
 }
 
-bool Create(const base::FilePath& file_path, base::File* file) {
-  DCHECK(file);
-
-  file->Initialize(file_path, base::File::FLAG_CREATE_ALWAYS |
-                                  base::File::FLAG_READ |
-                                  base::File::FLAG_WRITE);
-
-  return file->IsValid();
-}
-
-bool Open(const base::FilePath& file_path, base::File* file) {
-  DCHECK(file);
-
-  file->Initialize(file_path, base::File::FLAG_OPEN | base::File::FLAG_READ |
-                                  base::File::FLAG_WRITE);
-
-  return file->IsValid();
-}
-
-bool CreateOrOpen(const base::FilePath& file_path, base::File* file) {
-  DCHECK(file);
-
-  if (!base::PathExists(file_path)) {
-    return Create(file_path, file);
-  }
-
-  if (!Open(file_path, file)) {
-    return false;
-  }
-
-  return file->IsValid();
-}
-
-int64_t SeekFromEnd(base::File* file, int num_lines) {
-  DCHECK(file);
-
-  if (!file->IsValid()) {
-    return 0;
-  }
-
-  if (num_lines == 0) {
-    return 0;
-  }
-
-  int64_t length = file->GetLength();
-  if (length == -1) {
-    return -1;
-  }
-
-  if (length == 0) {
-    return 0;
-  }
-
-  int line_count = 0;
-
-  char chunk[kChunkSize];
-  int64_t chunk_size = kChunkSize;
-  int64_t last_chunk_size = 0;
-
-  if (file->Seek(base::File::FROM_END, 0) == -1) {
-    return -1;
-  }
-
-  do {
-    if (chunk_size > length) {
-      chunk_size = length;
-    }
-
-    const int64_t seek_offset = chunk_size + last_chunk_size;
-    if (file->Seek(base::File::FROM_CURRENT, -seek_offset) == -1) {
-      return -1;
-    }
-
-    if (file->ReadAtCurrentPos(chunk, chunk_size) == -1) {
-      return -1;
-    }
-
-    for (int i = chunk_size - 1; i >= 0; i--) {
-      if (chunk[i] == '\n') {
-        line_count++;
-        if (line_count == num_lines + 1) {
-          return length;
-        }
-      }
-
-      length--;
-    }
-
-    last_chunk_size = chunk_size;
-  } while (length > 0);
-
-  return length;
-}
-
-bool TrimBeginningOfFile(base::File* file, int keep_num_lines) {
-  DCHECK(file);
-
-  if (file->GetLength() == 0) {
-    return true;
-  }
-
-  const int64_t offset = SeekFromEnd(file, keep_num_lines);
-  if (offset == -1) {
-    return false;
-  }
-
-  if (offset == 0) {
-    return true;
-  }
-
-  if (file->Seek(base::File::FROM_BEGIN, offset) == -1) {
-    return false;
-  }
-
-  const int64_t size = file->GetLength() - offset;
-  std::unique_ptr<char[]> buffer = std::make_unique<char[]>(size + 1);
-
-  if (file->ReadAtCurrentPos(buffer.get(), size) == -1) {
-    return false;
-  }
-
-  if (file->Seek(base::File::FROM_BEGIN, 0) == -1) {
-    return false;
-  }
-
-  const std::string data = std::string(buffer.get());
-  const int64_t new_size = data.size();
-
-  if (file->WriteAtCurrentPos(data.c_str(), new_size) == -1) {
-    return false;
-  }
-
-  if (!file->SetLength(new_size)) {
-    return false;
-  }
-
-  return true;
-}
-
-bool MaybeTrimBeginningOfFile(base::File* file,
-                              int64_t max_file_size,
-                              int keep_num_lines,
-                              bool first_write) {
-  DCHECK(file);
-
-  const int64_t length = file->GetLength();
-  if (length == -1) {
-    return false;
-  }
-
-  // We do not trim the log on first run so that if the browser
-  // crashes and we investigate the log with the user they are able to
-  // re-run the browser without losing past logs.
-  if (!first_write && length <= max_file_size) {
-    return true;
-  }
-
-  if (!TrimBeginningOfFile(file, keep_num_lines)) {
-    return false;
-  }
-
-  return true;
-}
-
-std::string ReadLastNLinesOnFileTaskRunner(const base::FilePath& file_path,
-                                           int num_lines) {
-  base::File file;
-  if (!Open(file_path, &file)) {
-    return "";
-  }
-
-  if (file.GetLength() == 0) {
-    return "";
-  }
-
-  int64_t offset;
-
-  if (num_lines == -1) {
-    offset = 0;
-  } else {
-    offset = SeekFromEnd(&file, num_lines);
-    if (offset == -1) {
-      return "";
-    }
-  }
-
-  if (file.Seek(base::File::FROM_BEGIN, offset) == -1) {
-    return "";
-  }
-
-  const int64_t size = file.GetLength() - offset;
-  std::unique_ptr<char[]> buffer = std::make_unique<char[]>(size + 1);
-
-  if (file.ReadAtCurrentPos(buffer.get(), size) == -1) {
-    return "";
-  }
-
-  return std::string(buffer.get());
-}
-
-bool WriteOnFileTaskRunner(const base::FilePath& file_path,
-                           const std::string& log_entry,
-                           int64_t max_file_size,
-                           int keep_num_lines,
-                           bool first_write) {
-  base::File file;
-  if (!CreateOrOpen(file_path, &file)) {
-    return false;
-  }
-
-  if (file.Seek(base::File::FROM_END, 0) == -1) {
-    return false;
-  }
-
-  if (first_write) {
-    const std::string divider = std::string(kDividerLength, '-') + "\n";
-    file.WriteAtCurrentPos(divider.c_str(), divider.length());
-  }
-
-  if (file.WriteAtCurrentPos(log_entry.c_str(), log_entry.length()) == -1) {
-    return false;
-  }
-
-  return MaybeTrimBeginningOfFile(&file, max_file_size, keep_num_lines,
-                                  first_write);
-}
-
-bool DeleteOnFileTaskRunner(const base::FilePath& file_path) {
-  return base::DeleteFile(file_path);
-}
-
 }  // namespace
 
 namespace brave_rewards {
 
 DiagnosticLog::DiagnosticLog(const base::FilePath& file_path,
-                             int64_t max_file_size,
-                             int keep_num_lines)
+                             int64_t max_file_size)
     : file_task_runner_(base::ThreadPool::CreateSequencedTaskRunner(
           {base::MayBlock(), base::TaskPriority::USER_VISIBLE,
            base::TaskShutdownBehavior::BLOCK_SHUTDOWN})),
-      file_path_(file_path),
-      max_file_size_(max_file_size),
-      keep_num_lines_(keep_num_lines),
+      segments_(new DiagnosticLogSegments(file_path, max_file_size),
+                base::OnTaskRunnerDeleter(file_task_runner_)),
       first_write_(true) {}
 
 DiagnosticLog::~DiagnosticLog() {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  // Posted before |segments_| is deleted, so buffered entries are not lost.
+  Flush();
 }
 
 void DiagnosticLog::ReadLastNLines(int num_lines, ReadCallback callback) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  Flush();
   file_task_runner_->PostTaskAndReplyWithResult(
       FROM_HERE,
-      base::BindOnce(&ReadLastNLinesOnFileTaskRunner, file_path_, num_lines),
+      base::BindOnce(&DiagnosticLogSegments::ReadLastNLines,
+                     base::Unretained(segments_.get()), num_lines),
       base::BindOnce(&DiagnosticLog::OnReadLastNLines, AsWeakPtr(),
                      std::move(callback)));
 }
@@ -310,13 +85,19 @@ void DiagnosticLog::ReadLastNLines(int num_lines, ReadCallback callback) {
 void DiagnosticLog::Write(const std::string& log_entry,
                           StatusCallback callback) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
-  file_task_runner_->PostTaskAndReplyWithResult(
-      FROM_HERE,
-      base::BindOnce(&WriteOnFileTaskRunner, file_path_, log_entry,
-                     max_file_size_, keep_num_lines_, first_write_),
-      base::BindOnce(&DiagnosticLog::OnWrite, AsWeakPtr(),
-                     std::move(callback)));
-  first_write_ = false;
+  pending_entries_.append(log_entry);
+  pending_callbacks_.push_back(std::move(callback));
+
+  if (pending_entries_.size() >= kMaxPendingSize) {
+    Flush();
+    return;
+  }
+
+  if (!flush_timer_.IsRunning()) {
+    flush_timer_.Start(FROM_HERE, kFlushDelay,
+                       base::BindOnce(&DiagnosticLog::Flush,
+                                      base::Unretained(this)));
+  }
 }
 
 void DiagnosticLog::Write(const std::string& log_entry,
@@ -342,21 +123,54 @@ void DiagnosticLog::Write(const std::string& log_entry,
 
 void DiagnosticLog::Delete(StatusCallback callback) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  Flush();
   file_task_runner_->PostTaskAndReplyWithResult(
-      FROM_HERE, base::BindOnce(&DeleteOnFileTaskRunner, file_path_),
+      FROM_HERE,
+      base::BindOnce(&DiagnosticLogSegments::Delete,
+                     base::Unretained(segments_.get())),
       base::BindOnce(&DiagnosticLog::OnDelete, AsWeakPtr(),
                      std::move(callback)));
 }
 
+void DiagnosticLog::Flush() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  flush_timer_.Stop();
+
+  if (pending_callbacks_.empty()) {
+    return;
+  }
+
+  std::string data;
+  if (first_write_) {
+    // Each run of the browser starts a new segment, headed by a divider
+    data = std::string(kDividerLength, '-') + "\n";
+  }
+  data.append(pending_entries_);
+  pending_entries_.clear();
+
+  file_task_runner_->PostTaskAndReplyWithResult(
+      FROM_HERE,
+      base::BindOnce(&DiagnosticLogSegments::Append,
+                     base::Unretained(segments_.get()), std::move(data),
+                     first_write_),
+      base::BindOnce(&DiagnosticLog::OnWrite, AsWeakPtr(),
+                     std::move(pending_callbacks_)));
+  pending_callbacks_.clear();
+  first_write_ = false;
+}
+
 void DiagnosticLog::OnReadLastNLines(ReadCallback callback,
                                      const std::string& data) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
   std::move(callback).Run(data);
 }
 
-void DiagnosticLog::OnWrite(StatusCallback callback, bool result) {
+void DiagnosticLog::OnWrite(std::vector<StatusCallback> callbacks,
+                            bool result) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
-  std::move(callback).Run(result);
+  for (auto& callback : callbacks) {
+    std::move(callback).Run(result);
+  }
 }
 
 void DiagnosticLog::OnDelete(StatusCallback callback, bool result) {
@@ -6,23 +6,26 @@
 #ifndef BRAVE_COMPONENTS_BRAVE_REWARDS_BROWSER_DIAGNOSTIC_LOG_H_
 #define BRAVE_COMPONENTS_BRAVE_REWARDS_BROWSER_DIAGNOSTIC_LOG_H_
 
+#include <memory>
 #include <string>
+#include <vector>
 
-#include "base/files/file.h"
 #include "base/files/file_path.h"
 #include "base/sequence_checker.h"
 #include "base/sequenced_task_runner.h"
+#include "base/timer/timer.h"
 
 namespace brave_rewards {
 
-// This class provides access to a diagnostic log file. If the file
-// size ever exceeds the provided maximum file size, it is trimmed to
-// keep only the last n lines.
+class DiagnosticLogSegments;
+
+// This class provides access to a diagnostic log. The log is stored in
+// segment files that are rotated so that their total size stays within the
+// provided maximum file size, see DiagnosticLogSegments. Log entries are
+// buffered and written in batches.
 class DiagnosticLog : public base::SupportsWeakPtr<DiagnosticLog> {
  public:
-  DiagnosticLog(const base::FilePath& path,
-                int64_t max_file_size,
-                int keep_num_lines);
+  DiagnosticLog(const base::FilePath& path, int64_t max_file_size);
   DiagnosticLog(const DiagnosticLog&) = delete;
   DiagnosticLog& operator=(const DiagnosticLog&) = delete;
   ~DiagnosticLog();
@@ -34,9 +37,8 @@ class DiagnosticLog : public base::SupportsWeakPtr<DiagnosticLog> {
   // the entire file.
   void ReadLastNLines(int num_lines, ReadCallback callback);
 
-  // Appends |log_entry| to end of file. If file doesn't exist, it is
-  // created. If total file size exceeds |max_file_size|, removes all
-  // but the last |keep_num_lines| lines.
+  // Appends |log_entry| to the end of the log. The entry is buffered and
+  // |callback| runs once the batch containing it has been written.
   void Write(const std::string& log_entry, StatusCallback callback);
   void Write(const std::string& log_entry,
              const base::Time& time,
@@ -45,20 +47,25 @@ class DiagnosticLog : public base::SupportsWeakPtr<DiagnosticLog> {
              int verbose_level,
              StatusCallback callback);
 
-  // Deletes the file.
+  // Deletes the log.
   void Delete(StatusCallback callback);
 
  private:
+  // Writes the buffered log entries.
+  void Flush();
+
   void OnReadLastNLines(ReadCallback callback, const std::string& data);
-  void OnWrite(StatusCallback callback, bool result);
+  void OnWrite(std::vector<StatusCallback> callbacks, bool result);
   void OnDelete(StatusCallback callback, bool result);
 
   scoped_refptr<base::SequencedTaskRunner> file_task_runner_;
-  base::FilePath file_path_;
-  int64_t max_file_size_;
-  int keep_num_lines_;
+  std::unique_ptr<DiagnosticLogSegments, base::OnTaskRunnerDeleter> segments_;
   bool first_write_;
 
+  std::string pending_entries_;
+  std::vector<StatusCallback> pending_callbacks_;
+  base::OneShotTimer flush_timer_;
+
   SEQUENCE_CHECKER(sequence_checker_);
 };
 
@@ -0,0 +1,227 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_rewards/browser/diagnostic_log_segments.h"
+
+#include <algorithm>
+
+#include "base/files/file_enumerator.h"
+#include "base/files/file_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_util.h"
+
+namespace {
+
+// The log is split into this many segments, so rotating drops roughly this
+// fraction of it at a time
+constexpr int64_t kSegmentCount = 8;
+
+// Each run of the browser starts a new segment, so short runs can leave many
+// small segments behind
+constexpr size_t kMaxSegmentCount = 4 * kSegmentCount;
+
+int64_t CountLines(const std::string& data) {
+  return std::count(data.begin(), data.end(), '\n');
+}
+
+}  // namespace
+
+namespace brave_rewards {
+
+DiagnosticLogSegments::DiagnosticLogSegments(const base::FilePath& path,
+                                             int64_t max_total_size)
+    : path_(path),
+      max_total_size_(max_total_size),
+      max_segment_size_(std::max<int64_t>(max_total_size / kSegmentCount, 1)) {
+  DETACH_FROM_SEQUENCE(sequence_checker_);
+}
+
+DiagnosticLogSegments::~DiagnosticLogSegments() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+}
+
+bool DiagnosticLogSegments::Append(const std::string& data,
+                                   bool start_new_segment) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  LoadIndex();
+
+  if (segments_.empty() || start_new_segment ||
+      segments_.back().size >= max_segment_size_) {
+    if (!StartSegment()) {
+      return false;
+    }
+  } else if (!file_.IsValid()) {
+    file_.Initialize(GetSegmentPath(segments_.back().sequence),
+                     base::File::FLAG_OPEN_ALWAYS | base::File::FLAG_APPEND);
+    if (!file_.IsValid()) {
+      return false;
+    }
+  }
+
+  const int size = static_cast<int>(data.size());
+  if (file_.WriteAtCurrentPos(data.data(), size) != size) {
+    return false;
+  }
+
+  Segment& segment = segments_.back();
+  segment.size += size;
+  segment.line_count += CountLines(data);
+  total_size_ += size;
+
+  return true;
+}
+
+std::string DiagnosticLogSegments::ReadLastNLines(int num_lines) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  LoadIndex();
+
+  if (num_lines == 0) {
+    return "";
+  }
+
+  // The lines are preceded by the newline that ends the line before them, so
+  // read newer segments until one more newline than |num_lines| is included
+  size_t first_segment = 0;
+  if (num_lines != -1) {
+    int64_t line_count = 0;
+    first_segment = segments_.size();
+    while (first_segment > 0 && line_count <= num_lines) {
+      first_segment--;
+      line_count += segments_[first_segment].line_count;
+    }
+  }
+
+  std::string data;
+  for (size_t i = first_segment; i < segments_.size(); i++) {
+    std::string contents;
+    if (!base::ReadFileToString(GetSegmentPath(segments_[i].sequence),
+                                &contents)) {
+      return "";
+    }
+    data.append(contents);
+  }
+
+  if (num_lines == -1) {
+    return data;
+  }
+
+  int line_count = 0;
+  for (size_t i = data.size(); i > 0; i--) {
+    if (data[i - 1] == '\n' && ++line_count == num_lines + 1) {
+      return data.substr(i);
+    }
+  }
+
+  return data;
+}
+
+bool DiagnosticLogSegments::Delete() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  LoadIndex();
+  file_.Close();
+
+  bool result = true;
+  for (const auto& segment : segments_) {
+    result &= base::DeleteFile(GetSegmentPath(segment.sequence));
+  }
+  result &= base::DeleteFile(path_);
+
+  segments_.clear();
+  total_size_ = 0;
+
+  return result;
+}
+
+base::FilePath DiagnosticLogSegments::GetSegmentPath(uint64_t sequence) const {
+  return path_.AddExtensionASCII(base::NumberToString(sequence));
+}
+
+void DiagnosticLogSegments::LoadIndex() {
+  if (index_loaded_) {
+    return;
+  }
+
+  index_loaded_ = true;
+
+  const std::string prefix = path_.BaseName().AsUTF8Unsafe() + ".";
+  base::FileEnumerator enumerator(
+      path_.DirName(), false, base::FileEnumerator::FILES,
+      path_.BaseName().value() + FILE_PATH_LITERAL(".*"));
+  for (base::FilePath segment_path = enumerator.Next(); !segment_path.empty();
+       segment_path = enumerator.Next()) {
+    const std::string name = segment_path.BaseName().AsUTF8Unsafe();
+    Segment segment;
+    if (!base::StartsWith(name, prefix) ||
+        !base::StringToUint64(name.substr(prefix.size()), &segment.sequence)) {
+      continue;
+    }
+
+    std::string contents;
+    if (!base::ReadFileToString(segment_path, &contents)) {
+      continue;
+    }
+
+    segment.size = contents.size();
+    segment.line_count = CountLines(contents);
+    segments_.push_back(segment);
+  }
+
+  std::sort(segments_.begin(), segments_.end(),
+            [](const Segment& a, const Segment& b) {
+              return a.sequence < b.sequence;
+            });
+
+  // Logs written before segments were introduced are kept as the first
+  // segment
+  std::string contents;
+  if (base::ReadFileToString(path_, &contents)) {
+    if (segments_.empty() && base::Move(path_, GetSegmentPath(0))) {
+      Segment segment;
+      segment.size = contents.size();
+      segment.line_count = CountLines(contents);
+      segments_.push_back(segment);
+    } else {
+      base::DeleteFile(path_);
+    }
+  }
+
+  for (const auto& segment : segments_) {
+    total_size_ += segment.size;
+  }
+}
+
+bool DiagnosticLogSegments::StartSegment() {
+  file_.Close();
+
+  Segment segment;
+  if (!segments_.empty()) {
+    segment.sequence = segments_.back().sequence + 1;
+  }
+
+  file_.Initialize(GetSegmentPath(segment.sequence),
+                   base::File::FLAG_CREATE_ALWAYS | base::File::FLAG_APPEND);
+  if (!file_.IsValid()) {
+    return false;
+  }
+
+  segments_.push_back(segment);
+  DeleteOldSegments();
+
+  return true;
+}
+
+void DiagnosticLogSegments::DeleteOldSegments() {
+  // Leave room for the newest segment to fill up
+  while (segments_.size() > 1 &&
+         (total_size_ + max_segment_size_ > max_total_size_ ||
+          segments_.size() > kMaxSegmentCount)) {
+    const Segment& oldest = segments_.front();
+    base::DeleteFile(GetSegmentPath(oldest.sequence));
+    total_size_ -= oldest.size;
+    segments_.pop_front();
+  }
+}
+
+}  // namespace brave_rewards
@@ -0,0 +1,74 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_REWARDS_BROWSER_DIAGNOSTIC_LOG_SEGMENTS_H_
+#define BRAVE_COMPONENTS_BRAVE_REWARDS_BROWSER_DIAGNOSTIC_LOG_SEGMENTS_H_
+
+#include <stdint.h>
+
+#include <deque>
+#include <string>
+
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/sequence_checker.h"
+
+namespace brave_rewards {
+
+// Stores a diagnostic log as a ring of segment files named after |path|
+// followed by an increasing sequence number, e.g. "Rewards.log.12". Data is
+// only ever appended to the newest segment. Once it is full a new segment is
+// started and the oldest segments are deleted to stay within
+// |max_total_size|, so the log never has to be rewritten. The number of lines
+// in each segment is kept in memory so that reading the end of the log only
+// reads the segments that contain it. Must be used on a sequence that allows
+// blocking.
+class DiagnosticLogSegments {
+ public:
+  DiagnosticLogSegments(const base::FilePath& path, int64_t max_total_size);
+  DiagnosticLogSegments(const DiagnosticLogSegments&) = delete;
+  DiagnosticLogSegments& operator=(const DiagnosticLogSegments&) = delete;
+  ~DiagnosticLogSegments();
+
+  // Appends |data| to the newest segment, first starting a new segment if it
+  // is full or if |start_new_segment| is true.
+  bool Append(const std::string& data, bool start_new_segment);
+
+  // Returns the last |num_lines| lines of the log, or the whole log if
+  // |num_lines| is -1.
+  std::string ReadLastNLines(int num_lines);
+
+  // Deletes every segment.
+  bool Delete();
+
+ private:
+  struct Segment {
+    uint64_t sequence = 0;
+    int64_t size = 0;
+    int64_t line_count = 0;
+  };
+
+  base::FilePath GetSegmentPath(uint64_t sequence) const;
+  void LoadIndex();
+  bool StartSegment();
+  void DeleteOldSegments();
+
+  const base::FilePath path_;
+  const int64_t max_total_size_;
+  const int64_t max_segment_size_;
+
+  bool index_loaded_ = false;
+  // Oldest segment first
+  std::deque<Segment> segments_;
+  int64_t total_size_ = 0;
+  // The newest segment, kept open for appending
+  base::File file_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+};
+
+}  // namespace brave_rewards
+
+#endif  // BRAVE_COMPONENTS_BRAVE_REWARDS_BROWSER_DIAGNOSTIC_LOG_SEGMENTS_H_
@@ -0,0 +1,111 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_rewards/browser/diagnostic_log_segments.h"
+
+#include <string>
+
+#include "base/files/file_enumerator.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/strings/stringprintf.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+// npm run test -- brave_unit_tests --filter=DiagnosticLogSegmentsTest.*
+
+namespace brave_rewards {
+
+class DiagnosticLogSegmentsTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    path_ = temp_dir_.GetPath().AppendASCII("Rewards.log");
+  }
+
+  int CountSegmentFiles() const {
+    int count = 0;
+    base::FileEnumerator enumerator(temp_dir_.GetPath(), false,
+                                    base::FileEnumerator::FILES,
+                                    FILE_PATH_LITERAL("Rewards.log.*"));
+    for (base::FilePath path = enumerator.Next(); !path.empty();
+         path = enumerator.Next()) {
+      count++;
+    }
+    return count;
+  }
+
+  base::ScopedTempDir temp_dir_;
+  base::FilePath path_;
+};
+
+TEST_F(DiagnosticLogSegmentsTest, ReadLastNLines) {
+  DiagnosticLogSegments segments(path_, 1024 * 1024);
+  ASSERT_TRUE(segments.Append("one\ntwo\n", true));
+  ASSERT_TRUE(segments.Append("three\n", false));
+  ASSERT_TRUE(segments.Append("four\nfive\n", true));
+
+  EXPECT_EQ(segments.ReadLastNLines(-1), "one\ntwo\nthree\nfour\nfive\n");
+  EXPECT_EQ(segments.ReadLastNLines(1), "five\n");
+  EXPECT_EQ(segments.ReadLastNLines(3), "three\nfour\nfive\n");
+  EXPECT_EQ(segments.ReadLastNLines(10), "one\ntwo\nthree\nfour\nfive\n");
+  EXPECT_EQ(segments.ReadLastNLines(0), "");
+  EXPECT_EQ(CountSegmentFiles(), 2);
+}
+
+TEST_F(DiagnosticLogSegmentsTest, RotatesWithoutExceedingMaxSize) {
+  const int64_t max_size = 8 * 100;
+  DiagnosticLogSegments segments(path_, max_size);
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_TRUE(segments.Append(base::StringPrintf("line %04d\n", i), false));
+  }
+
+  int64_t total_size = 0;
+  base::FileEnumerator enumerator(temp_dir_.GetPath(), false,
+                                  base::FileEnumerator::FILES);
+  for (base::FilePath path = enumerator.Next(); !path.empty();
+       path = enumerator.Next()) {
+    total_size += enumerator.GetInfo().GetSize();
+  }
+  EXPECT_LE(total_size, max_size);
+  EXPECT_EQ(segments.ReadLastNLines(2), "line 0998\nline 0999\n");
+}
+
+TEST_F(DiagnosticLogSegmentsTest, LoadsExistingSegments) {
+  {
+    DiagnosticLogSegments segments(path_, 1024 * 1024);
+    ASSERT_TRUE(segments.Append("one\n", true));
+    ASSERT_TRUE(segments.Append("two\n", true));
+  }
+
+  DiagnosticLogSegments segments(path_, 1024 * 1024);
+  EXPECT_EQ(segments.ReadLastNLines(-1), "one\ntwo\n");
+  ASSERT_TRUE(segments.Append("three\n", false));
+  EXPECT_EQ(segments.ReadLastNLines(2), "two\nthree\n");
+  EXPECT_EQ(CountSegmentFiles(), 2);
+}
+
+TEST_F(DiagnosticLogSegmentsTest, MigratesSingleFileLog) {
+  ASSERT_TRUE(base::WriteFile(path_, "one\ntwo\n"));
+
+  DiagnosticLogSegments segments(path_, 1024 * 1024);
+  ASSERT_TRUE(segments.Append("three\n", true));
+  EXPECT_EQ(segments.ReadLastNLines(-1), "one\ntwo\nthree\n");
+  EXPECT_FALSE(base::PathExists(path_));
+}
+
+TEST_F(DiagnosticLogSegmentsTest, Delete) {
+  DiagnosticLogSegments segments(path_, 1024 * 1024);
+  ASSERT_TRUE(segments.Append("one\n", true));
+  ASSERT_TRUE(segments.Append("two\n", true));
+
+  EXPECT_TRUE(segments.Delete());
+  EXPECT_EQ(CountSegmentFiles(), 0);
+  EXPECT_EQ(segments.ReadLastNLines(-1), "");
+
+  ASSERT_TRUE(segments.Append("three\n", false));
+  EXPECT_EQ(segments.ReadLastNLines(-1), "three\n");
+}
+
+}  // namespace brave_rewards
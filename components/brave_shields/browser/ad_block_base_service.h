@@ -14,6 +14,7 @@
 #include <vector>
 
 #include "base/files/file_path.h"
+#include "base/memory/scoped_refptr.h"
 #include "base/memory/weak_ptr.h"
 #include "base/sequence_checker.h"
 #include "base/values.h"
@@ -31,6 +32,8 @@ class Engine;
 
 namespace brave_shields {
 
+class AdBlockEngine;
+
 // The base class of the brave shields service in charge of ad-block
 // checking and init.
 class AdBlockBaseService : public BaseBraveShieldsService {
@@ -63,6 +66,9 @@ class AdBlockBaseService : public BaseBraveShieldsService {
       const std::vector<std::string>& ids,
       const std::vector<std::string>& exceptions);
 
+  // Returns the current engine, which must only be used on |GetTaskRunner()|
+  scoped_refptr<AdBlockEngine> GetEngine();
+
  protected:
   friend class ::AdBlockServiceTest;
   friend class ::BraveAdBlockTPNetworkDelegateHelperTest;
@@ -70,18 +76,18 @@ class AdBlockBaseService : public BaseBraveShieldsService {
   bool Init() override;
 
   void GetDATFileData(const base::FilePath& dat_file_path);
+  void UpdateAdBlockClient(
+      std::unique_ptr<adblock::Engine> ad_block_client);
   void AddKnownTagsToAdBlockInstance();
   void AddKnownResourcesToAdBlockInstance();
   void ResetForTest(const std::string& rules, const std::string& resources);
 
-  std::unique_ptr<adblock::Engine> ad_block_client_;
-
  private:
-  void UpdateAdBlockClient(
-      std::unique_ptr<adblock::Engine> ad_block_client);
   void OnGetDATFileData(GetDATFileDataResult result);
   void OnPreferenceChanges(const std::string& pref_name);
 
+  scoped_refptr<AdBlockEngine> engine_;
+
   std::vector<std::string> tags_;
   std::string resources_;
   base::WeakPtrFactory<AdBlockBaseService> weak_factory_;
@@ -5,6 +5,8 @@
 
 #include "brave/components/brave_shields/browser/ad_block_custom_filters_service.h"
 
+#include <memory>
+
 #include "base/logging.h"
 #include "brave/components/adblock_rust_ffi/src/wrapper.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
@@ -84,7 +86,7 @@ bool AdBlockCustomFiltersService::MigrateLegacyCosmeticFilters(
 void AdBlockCustomFiltersService::UpdateCustomFiltersOnFileTaskRunner(
     const std::string& custom_filters) {
   DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
-  ad_block_client_.reset(new adblock::Engine(custom_filters.c_str()));
+  UpdateAdBlockClient(std::make_unique<adblock::Engine>(custom_filters));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
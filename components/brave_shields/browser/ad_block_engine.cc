@@ -0,0 +1,182 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_engine.h"
+
+#include <utility>
+
+#include "base/check.h"
+#include "brave/components/adblock_rust_ffi/src/wrapper.h"
+#include "brave/components/brave_shields/browser/registrable_domain_cache.h"
+
+namespace {
+
+std::string ResourceTypeToString(blink::mojom::ResourceType resource_type) {
+  std::string filter_option = "";
+  switch (resource_type) {
+    // top level page
+    case blink::mojom::ResourceType::kMainFrame:
+      filter_option = "main_frame";
+      break;
+    // frame or iframe
+    case blink::mojom::ResourceType::kSubFrame:
+      filter_option = "sub_frame";
+      break;
+    // a CSS stylesheet
+    case blink::mojom::ResourceType::kStylesheet:
+      filter_option = "stylesheet";
+      break;
+    // an external script
+    case blink::mojom::ResourceType::kScript:
+      filter_option = "script";
+      break;
+    // an image (jpg/gif/png/etc)
+    case blink::mojom::ResourceType::kFavicon:
+    case blink::mojom::ResourceType::kImage:
+      filter_option = "image";
+      break;
+    // a font
+    case blink::mojom::ResourceType::kFontResource:
+      filter_option = "font";
+      break;
+    // an "other" subresource.
+    case blink::mojom::ResourceType::kSubResource:
+      filter_option = "other";
+      break;
+    // an object (or embed) tag for a plugin.
+    case blink::mojom::ResourceType::kObject:
+      filter_option = "object";
+      break;
+    // a media resource.
+    case blink::mojom::ResourceType::kMedia:
+      filter_option = "media";
+      break;
+    // a XMLHttpRequest
+    case blink::mojom::ResourceType::kXhr:
+      filter_option = "xhr";
+      break;
+    // a ping request for <a ping>/sendBeacon.
+    case blink::mojom::ResourceType::kPing:
+      filter_option = "ping";
+      break;
+    // the main resource of a dedicated worker.
+    case blink::mojom::ResourceType::kWorker:
+    // the main resource of a shared worker.
+    case blink::mojom::ResourceType::kSharedWorker:
+    // an explicitly requested prefetch
+    case blink::mojom::ResourceType::kPrefetch:
+    // the main resource of a service worker.
+    case blink::mojom::ResourceType::kServiceWorker:
+    // a report of Content Security Policy violations.
+    case blink::mojom::ResourceType::kCspReport:
+    // a resource that a plugin requested.
+    case blink::mojom::ResourceType::kPluginResource:
+    default:
+      break;
+  }
+  return filter_option;
+}
+
+}  // namespace
+
+namespace brave_shields {
+
+AdBlockRequest::AdBlockRequest(const GURL& url,
+                               blink::mojom::ResourceType resource_type,
+                               const std::string& tab_host)
+    // Determine third-party here so the library doesn't need to figure it out
+    : AdBlockRequest(url,
+                     resource_type,
+                     tab_host,
+                     !SameRegistrableDomainOrHost(url.host(), tab_host)) {}
+
+AdBlockRequest::AdBlockRequest(const GURL& url,
+                               blink::mojom::ResourceType resource_type,
+                               const std::string& tab_host,
+                               bool is_third_party)
+    : url(url.spec()),
+      host(url.host()),
+      tab_host(tab_host),
+      is_third_party(is_third_party),
+      resource_type(ResourceTypeToString(resource_type)) {}
+
+AdBlockRequest::~AdBlockRequest() = default;
+
+AdBlockEngine::AdBlockEngine(std::unique_ptr<adblock::Engine> engine)
+    : engine_(std::move(engine)) {
+  DCHECK(engine_);
+}
+
+AdBlockEngine::~AdBlockEngine() = default;
+
+void AdBlockEngine::ShouldStartRequest(
+    const GURL& url,
+    blink::mojom::ResourceType resource_type,
+    const std::string& tab_host,
+    bool* did_match_rule,
+    bool* did_match_exception,
+    bool* did_match_important,
+    std::string* mock_data_url) {
+  const AdBlockRequest request(url, resource_type, tab_host);
+  ShouldStartRequest(request, did_match_rule, did_match_exception,
+                     did_match_important, mock_data_url);
+}
+
+void AdBlockEngine::ShouldStartRequest(const AdBlockRequest& request,
+                                       bool* did_match_rule,
+                                       bool* did_match_exception,
+                                       bool* did_match_important,
+                                       std::string* mock_data_url) {
+  engine_->matches(request.url, request.host, request.tab_host,
+                   request.is_third_party, request.resource_type,
+                   did_match_rule, did_match_exception, did_match_important,
+                   mock_data_url);
+}
+
+absl::optional<std::string> AdBlockEngine::GetCspDirectives(
+    const GURL& url,
+    blink::mojom::ResourceType resource_type,
+    const std::string& tab_host) {
+  const AdBlockRequest request(url, resource_type, tab_host);
+  return GetCspDirectives(request);
+}
+
+absl::optional<std::string> AdBlockEngine::GetCspDirectives(
+    const AdBlockRequest& request) {
+  const std::string result = engine_->getCspDirectives(
+      request.url, request.host, request.tab_host, request.is_third_party,
+      request.resource_type);
+
+  if (result.empty()) {
+    return absl::nullopt;
+  } else {
+    return absl::optional<std::string>(result);
+  }
+}
+
+std::string AdBlockEngine::UrlCosmeticResources(const std::string& url) {
+  return engine_->urlCosmeticResources(url);
+}
+
+std::string AdBlockEngine::HiddenClassIdSelectors(
+    const std::vector<std::string>& classes,
+    const std::vector<std::string>& ids,
+    const std::vector<std::string>& exceptions) {
+  return engine_->hiddenClassIdSelectors(classes, ids, exceptions);
+}
+
+void AdBlockEngine::AddTag(const std::string& tag) {
+  engine_->addTag(tag);
+}
+
+void AdBlockEngine::RemoveTag(const std::string& tag) {
+  engine_->removeTag(tag);
+}
+
+void AdBlockEngine::AddResources(const std::string& resources) {
+  engine_->addResources(resources);
+}
+
+}  // namespace brave_shields
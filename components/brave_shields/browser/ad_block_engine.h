@@ -0,0 +1,98 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_ENGINE_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_ENGINE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+#include "third_party/blink/public/mojom/loader/resource_load_info.mojom-shared.h"
+#include "url/gurl.h"
+
+namespace adblock {
+class Engine;
+}
+
+namespace brave_shields {
+
+// Request state shared by every engine checking a request, so that it is
+// computed once per request rather than once per engine.
+struct AdBlockRequest {
+  AdBlockRequest(const GURL& url,
+                 blink::mojom::ResourceType resource_type,
+                 const std::string& tab_host);
+  // For callers that already know whether |url| is third-party to |tab_host|
+  AdBlockRequest(const GURL& url,
+                 blink::mojom::ResourceType resource_type,
+                 const std::string& tab_host,
+                 bool is_third_party);
+  ~AdBlockRequest();
+
+  const std::string url;
+  const std::string host;
+  const std::string tab_host;
+  const bool is_third_party;
+  const std::string resource_type;
+
+  DISALLOW_COPY_AND_ASSIGN(AdBlockRequest);
+};
+
+// Wraps an adblock-rust engine. adblock-rust engines are not thread-safe, even
+// for matching: the FFI takes a mutable reference to the engine on every call,
+// so none of the queries below are const. An engine must only be used on the
+// shields task runner of the service that owns it. This wrapper is a refactor
+// with no change in behaviour, matching stays serialized on that sequence. It
+// is ref-counted so that the regional service manager can match against the
+// engines of its services without holding its lock, while a service is being
+// removed on the UI thread.
+class AdBlockEngine : public base::RefCountedThreadSafe<AdBlockEngine> {
+ public:
+  explicit AdBlockEngine(std::unique_ptr<adblock::Engine> engine);
+
+  void ShouldStartRequest(const GURL& url,
+                          blink::mojom::ResourceType resource_type,
+                          const std::string& tab_host,
+                          bool* did_match_rule,
+                          bool* did_match_exception,
+                          bool* did_match_important,
+                          std::string* mock_data_url);
+  void ShouldStartRequest(const AdBlockRequest& request,
+                          bool* did_match_rule,
+                          bool* did_match_exception,
+                          bool* did_match_important,
+                          std::string* mock_data_url);
+  absl::optional<std::string> GetCspDirectives(
+      const GURL& url,
+      blink::mojom::ResourceType resource_type,
+      const std::string& tab_host);
+  absl::optional<std::string> GetCspDirectives(const AdBlockRequest& request);
+  std::string UrlCosmeticResources(const std::string& url);
+  std::string HiddenClassIdSelectors(
+      const std::vector<std::string>& classes,
+      const std::vector<std::string>& ids,
+      const std::vector<std::string>& exceptions);
+
+  void AddTag(const std::string& tag);
+  void RemoveTag(const std::string& tag);
+  void AddResources(const std::string& resources);
+
+ private:
+  friend class base::RefCountedThreadSafe<AdBlockEngine>;
+
+  ~AdBlockEngine();
+
+  const std::unique_ptr<adblock::Engine> engine_;
+
+  DISALLOW_COPY_AND_ASSIGN(AdBlockEngine);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_ENGINE_H_
@@ -0,0 +1,175 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_engine.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/base_paths.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/json/json_reader.h"
+#include "base/path_service.h"
+#include "base/strings/string_split.h"
+#include "base/strings/stringprintf.h"
+#include "base/values.h"
+#include "base/timer/lap_timer.h"
+#include "brave/components/adblock_rust_ffi/src/wrapper.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+#include "url/gurl.h"
+
+// npm run test -- brave_perftests --filter=AdBlockEnginePerfTest*
+
+namespace brave_shields {
+
+namespace {
+
+constexpr int kWarmupRuns = 1;
+constexpr base::TimeDelta kTimeLimit = base::TimeDelta::FromSeconds(2);
+constexpr int kTimeCheckInterval = 1;
+
+constexpr int kGeneratedRuleCount = 20000;
+constexpr int kReplaysPerLap = 20;
+
+constexpr char kMetricTimePerRequest[] = ".time_per_request";
+
+// A page load trace in the adblock-rust benchmark format, one JSON request per
+// line, covering first-party assets, CDNs, ad networks and analytics
+constexpr char kTraceFile[] = "request-trace.jsonl";
+
+std::string BuildRules() {
+  std::string rules =
+      "||googletagmanager.com^$third-party\n"
+      "||google-analytics.com^\n"
+      "||doubleclick.net^\n"
+      "||googlesyndication.com^\n"
+      "||facebook.net^$third-party\n"
+      "||facebook.com/tr/\n"
+      "/banner/*/ads.js\n"
+      "||ads-network.example^$script\n"
+      "@@||example-news.com/api/$xhr\n"
+      "example-news.com##.ad-container\n";
+
+  for (int i = 0; i < kGeneratedRuleCount; i++) {
+    rules += base::StringPrintf("||tracker%d.example^\n", i);
+  }
+
+  return rules;
+}
+
+struct Request {
+  GURL url;
+  blink::mojom::ResourceType resource_type;
+  std::string tab_host;
+};
+
+blink::mojom::ResourceType ResourceTypeFromCpt(const std::string& cpt) {
+  static const struct {
+    const char* cpt;
+    blink::mojom::ResourceType resource_type;
+  } kResourceTypes[] = {
+      {"main_frame", blink::mojom::ResourceType::kMainFrame},
+      {"sub_frame", blink::mojom::ResourceType::kSubFrame},
+      {"stylesheet", blink::mojom::ResourceType::kStylesheet},
+      {"script", blink::mojom::ResourceType::kScript},
+      {"image", blink::mojom::ResourceType::kImage},
+      {"font", blink::mojom::ResourceType::kFontResource},
+      {"media", blink::mojom::ResourceType::kMedia},
+      {"xmlhttprequest", blink::mojom::ResourceType::kXhr},
+      {"ping", blink::mojom::ResourceType::kPing},
+  };
+  for (const auto& entry : kResourceTypes) {
+    if (cpt == entry.cpt)
+      return entry.resource_type;
+  }
+  return blink::mojom::ResourceType::kSubResource;
+}
+
+std::vector<Request> LoadRequests() {
+  base::FilePath trace_path;
+  base::PathService::Get(base::DIR_SOURCE_ROOT, &trace_path);
+  trace_path = trace_path.AppendASCII("brave")
+                   .AppendASCII("test")
+                   .AppendASCII("data")
+                   .AppendASCII("adblock-data")
+                   .AppendASCII(kTraceFile);
+
+  std::string trace;
+  CHECK(base::ReadFileToString(trace_path, &trace)) << trace_path;
+
+  std::vector<Request> requests;
+  for (const auto& line : base::SplitStringPiece(
+           trace, "\n", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+    absl::optional<base::Value> entry = base::JSONReader::Read(line);
+    CHECK(entry && entry->is_dict()) << line;
+    const std::string* url = entry->FindStringKey("url");
+    const std::string* frame_url = entry->FindStringKey("frameUrl");
+    const std::string* cpt = entry->FindStringKey("cpt");
+    CHECK(url && frame_url && cpt) << line;
+
+    Request request;
+    request.url = GURL(*url);
+    request.resource_type = ResourceTypeFromCpt(*cpt);
+    request.tab_host = GURL(*frame_url).host();
+    requests.push_back(request);
+  }
+
+  return requests;
+}
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story) {
+  perf_test::PerfResultReporter reporter("AdBlockEngine.", story);
+  reporter.RegisterImportantMetric(kMetricTimePerRequest, "us");
+  return reporter;
+}
+
+}  // namespace
+
+class AdBlockEnginePerfTest : public testing::Test {
+ protected:
+  AdBlockEnginePerfTest()
+      : engine_(base::MakeRefCounted<AdBlockEngine>(
+            std::make_unique<adblock::Engine>(BuildRules()))),
+        requests_(LoadRequests()) {}
+
+  ~AdBlockEnginePerfTest() override = default;
+
+  scoped_refptr<AdBlockEngine> engine_;
+  const std::vector<Request> requests_;
+};
+
+// Replays the trace on one thread, as request checks run on the sequence of
+// the ad-block service. adblock-rust engines are not thread-safe, so they
+// can't be queried from several threads
+TEST_F(AdBlockEnginePerfTest, ReplayTrace) {
+  base::LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    for (int i = 0; i < kReplaysPerLap; i++) {
+      for (const auto& request : requests_) {
+        bool did_match_rule = false;
+        bool did_match_exception = false;
+        bool did_match_important = false;
+        std::string mock_data_url;
+        engine_->ShouldStartRequest(request.url, request.resource_type,
+                                    request.tab_host, &did_match_rule,
+                                    &did_match_exception, &did_match_important,
+                                    &mock_data_url);
+      }
+    }
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+
+  const size_t requests_per_lap = requests_.size() * kReplaysPerLap;
+
+  perf_test::PerfResultReporter reporter = SetUpReporter("replay_trace");
+  reporter.AddResult(kMetricTimePerRequest,
+                     timer.TimePerLap().InMicrosecondsF() / requests_per_lap);
+}
+
+}  // namespace brave_shields
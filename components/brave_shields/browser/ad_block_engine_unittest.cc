@@ -0,0 +1,105 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_engine.h"
+
+#include <memory>
+#include <string>
+
+#include "brave/components/adblock_rust_ffi/src/wrapper.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace brave_shields {
+
+namespace {
+
+scoped_refptr<AdBlockEngine> CreateEngine(const std::string& rules) {
+  return base::MakeRefCounted<AdBlockEngine>(
+      std::make_unique<adblock::Engine>(rules));
+}
+
+}  // namespace
+
+TEST(AdBlockEngineTest, RequestIsThirdParty) {
+  const AdBlockRequest request(GURL("https://ads.tracker.com/ad.js"),
+                               blink::mojom::ResourceType::kScript,
+                               "www.brave.com");
+
+  EXPECT_TRUE(request.is_third_party);
+  EXPECT_EQ("script", request.resource_type);
+  EXPECT_EQ("ads.tracker.com", request.host);
+}
+
+TEST(AdBlockEngineTest, RequestIsFirstParty) {
+  const AdBlockRequest request(GURL("https://cdn.brave.com/image.png"),
+                               blink::mojom::ResourceType::kImage,
+                               "www.brave.com");
+
+  EXPECT_FALSE(request.is_third_party);
+  EXPECT_EQ("image", request.resource_type);
+}
+
+TEST(AdBlockEngineTest, SharedRequestAccumulatesResultsAcrossEngines) {
+  const scoped_refptr<AdBlockEngine> default_engine =
+      CreateEngine("||tracker.com^");
+  const scoped_refptr<AdBlockEngine> custom_engine =
+      CreateEngine("@@||ads.tracker.com^");
+
+  const AdBlockRequest request(GURL("https://ads.tracker.com/ad.js"),
+                               blink::mojom::ResourceType::kScript,
+                               "www.brave.com");
+
+  bool did_match_rule = false;
+  bool did_match_exception = false;
+  bool did_match_important = false;
+  std::string mock_data_url;
+  default_engine->ShouldStartRequest(request, &did_match_rule,
+                                     &did_match_exception,
+                                     &did_match_important, &mock_data_url);
+  custom_engine->ShouldStartRequest(request, &did_match_rule,
+                                    &did_match_exception, &did_match_important,
+                                    &mock_data_url);
+
+  EXPECT_TRUE(did_match_rule);
+  EXPECT_TRUE(did_match_exception);
+  EXPECT_FALSE(did_match_important);
+}
+
+TEST(AdBlockEngineTest, SharedRequestMatchesPerEngineRequest) {
+  const scoped_refptr<AdBlockEngine> engine =
+      CreateEngine("||tracker.com^$important,third-party");
+
+  const GURL url("https://ads.tracker.com/ad.js");
+
+  bool did_match_rule = false;
+  bool did_match_exception = false;
+  bool did_match_important = false;
+  std::string mock_data_url;
+  engine->ShouldStartRequest(url, blink::mojom::ResourceType::kScript,
+                             "www.brave.com", &did_match_rule,
+                             &did_match_exception, &did_match_important,
+                             &mock_data_url);
+
+  const AdBlockRequest request(url, blink::mojom::ResourceType::kScript,
+                               "www.brave.com");
+
+  bool shared_did_match_rule = false;
+  bool shared_did_match_exception = false;
+  bool shared_did_match_important = false;
+  std::string shared_mock_data_url;
+  engine->ShouldStartRequest(request, &shared_did_match_rule,
+                             &shared_did_match_exception,
+                             &shared_did_match_important,
+                             &shared_mock_data_url);
+
+  EXPECT_TRUE(did_match_important);
+  EXPECT_EQ(did_match_rule, shared_did_match_rule);
+  EXPECT_EQ(did_match_exception, shared_did_match_exception);
+  EXPECT_EQ(did_match_important, shared_did_match_important);
+  EXPECT_EQ(mock_data_url, shared_mock_data_url);
+}
+
+}  // namespace brave_shields
@@ -13,6 +13,7 @@
 #include "base/task/post_task.h"
 #include "base/values.h"
 #include "brave/components/adblock_rust_ffi/src/wrapper.h"
+#include "brave/components/brave_shields/browser/ad_block_engine.h"
 #include "brave/components/brave_shields/browser/ad_block_regional_service.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
 #include "brave/components/brave_shields/browser/ad_block_service_helper.h"
@@ -123,12 +124,10 @@ void AdBlockRegionalServiceManager::ShouldStartRequest(
     bool* did_match_exception,
     bool* did_match_important,
     std::string* mock_data_url) {
-  base::AutoLock lock(regional_services_lock_);
-
-  for (const auto& regional_service : regional_services_) {
-    regional_service.second->ShouldStartRequest(
-        url, resource_type, tab_host, did_match_rule, did_match_exception,
-        did_match_important, mock_data_url);
+  const AdBlockRequest request(url, resource_type, tab_host);
+  for (const auto& engine : GetEngines()) {
+    engine->ShouldStartRequest(request, did_match_rule, did_match_exception,
+                               did_match_important, mock_data_url);
     if (did_match_important && *did_match_important) {
       return;
     }
@@ -139,17 +138,30 @@ absl::optional<std::string> AdBlockRegionalServiceManager::GetCspDirectives(
     const GURL& url,
     blink::mojom::ResourceType resource_type,
     const std::string& tab_host) {
+  const AdBlockRequest request(url, resource_type, tab_host);
   absl::optional<std::string> csp_directives = absl::nullopt;
 
-  for (const auto& regional_service : regional_services_) {
-    const auto directive =
-        regional_service.second->GetCspDirectives(url, resource_type, tab_host);
+  for (const auto& engine : GetEngines()) {
+    const auto directive = engine->GetCspDirectives(request);
     MergeCspDirectiveInto(directive, &csp_directives);
   }
 
   return csp_directives;
 }
 
+std::vector<scoped_refptr<AdBlockEngine>>
+AdBlockRegionalServiceManager::GetEngines() {
+  std::vector<scoped_refptr<AdBlockEngine>> engines;
+
+  // Take references to the engines so that queries do not hold the lock
+  base::AutoLock lock(regional_services_lock_);
+  for (const auto& regional_service : regional_services_) {
+    engines.push_back(regional_service.second->GetEngine());
+  }
+
+  return engines;
+}
+
 void AdBlockRegionalServiceManager::EnableTag(const std::string& tag,
                                               bool enabled) {
   base::AutoLock lock(regional_services_lock_);
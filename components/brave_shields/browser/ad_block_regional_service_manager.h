@@ -31,6 +31,7 @@ using brave_component_updater::BraveComponent;
 
 namespace brave_shields {
 
+class AdBlockEngine;
 class AdBlockRegionalService;
 
 // The AdBlock regional service manager, in charge of initializing and
@@ -61,6 +62,8 @@ class AdBlockRegionalServiceManager {
   void EnableTag(const std::string& tag, bool enabled);
   void AddResources(const std::string& resources);
   void EnableFilterList(const std::string& uuid, bool enabled);
+  // Returns the engines of the enabled regional lists, in matching order
+  std::vector<scoped_refptr<AdBlockEngine>> GetEngines();
 
   absl::optional<base::Value> UrlCosmeticResources(const std::string& url);
   absl::optional<base::Value> HiddenClassIdSelectors(
@@ -15,20 +15,23 @@
 #include "base/logging.h"
 #include "base/macros.h"
 #include "base/memory/ptr_util.h"
+#include "base/metrics/histogram_macros.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/time/time.h"
 #include "base/threading/thread_restrictions.h"
 #include "brave/components/adblock_rust_ffi/src/wrapper.h"
 #include "brave/components/brave_shields/browser/ad_block_custom_filters_service.h"
+#include "brave/components/brave_shields/browser/ad_block_engine.h"
 #include "brave/components/brave_shields/browser/ad_block_regional_service_manager.h"
 #include "brave/components/brave_shields/browser/ad_block_service_helper.h"
+#include "brave/components/brave_shields/browser/registrable_domain_cache.h"
 #include "brave/components/brave_shields/common/brave_shield_constants.h"
 #include "brave/components/brave_shields/common/features.h"
 #include "brave/components/brave_shields/common/pref_names.h"
 #include "components/prefs/pref_change_registrar.h"
 #include "components/prefs/pref_registry_simple.h"
 #include "components/prefs/pref_service.h"
-#include "net/base/registry_controlled_domains/registry_controlled_domain.h"
 
 #define DAT_FILE "rs-ABPFilterParserData.dat"
 #define REGIONAL_CATALOG "regional_catalog.json"
@@ -43,9 +46,7 @@ void AdBlockServiceDomainResolver(const char* host,
                                   uint32_t* start,
                                   uint32_t* end) {
   const auto host_str = std::string(host);
-  const auto domain = net::registry_controlled_domains::GetDomainAndRegistry(
-      host_str,
-      net::registry_controlled_domains::INCLUDE_PRIVATE_REGISTRIES);
+  const auto domain = GetRegistrableDomain(host_str);
   const size_t match = host_str.rfind(domain);
   if (match != std::string::npos) {
     *start = match;
@@ -58,6 +59,31 @@ void AdBlockServiceDomainResolver(const char* host,
 
 }  // namespace
 
+// static
+void AdBlockService::RecordEngineMatchTime(EngineType engine_type,
+                                           base::TimeDelta match_time) {
+  switch (engine_type) {
+    case EngineType::kDefault:
+      UMA_HISTOGRAM_CUSTOM_MICROSECONDS_TIMES(
+          "Brave.Shields.AdBlock.DefaultEngineMatchTime", match_time,
+          base::TimeDelta::FromMicroseconds(1),
+          base::TimeDelta::FromSeconds(1), 50);
+      break;
+    case EngineType::kRegional:
+      UMA_HISTOGRAM_CUSTOM_MICROSECONDS_TIMES(
+          "Brave.Shields.AdBlock.RegionalEngineMatchTime", match_time,
+          base::TimeDelta::FromMicroseconds(1),
+          base::TimeDelta::FromSeconds(1), 50);
+      break;
+    case EngineType::kCustom:
+      UMA_HISTOGRAM_CUSTOM_MICROSECONDS_TIMES(
+          "Brave.Shields.AdBlock.CustomEngineMatchTime", match_time,
+          base::TimeDelta::FromMicroseconds(1),
+          base::TimeDelta::FromSeconds(1), 50);
+      break;
+  }
+}
+
 std::string AdBlockService::g_ad_block_component_id_(kAdBlockComponentId);
 std::string AdBlockService::g_ad_block_component_base64_public_key_(
     kAdBlockComponentBase64PublicKey);
@@ -70,43 +96,58 @@ void AdBlockService::ShouldStartRequest(
     bool* did_match_exception,
     bool* did_match_important,
     std::string* mock_data_url) {
-  AdBlockBaseService::ShouldStartRequest(
-      url, resource_type, tab_host, did_match_rule, did_match_exception,
-      did_match_important, mock_data_url);
-  if (did_match_important && *did_match_important) {
-    return;
-  }
+  const AdBlockRequest request(url, resource_type, tab_host);
+  ShouldStartRequest(request, did_match_rule, did_match_exception,
+                     did_match_important, mock_data_url);
+}
 
-  regional_service_manager()->ShouldStartRequest(
-      url, resource_type, tab_host, did_match_rule, did_match_exception,
-      did_match_important, mock_data_url);
-  if (did_match_important && *did_match_important) {
-    return;
+void AdBlockService::ShouldStartRequest(const AdBlockRequest& request,
+                                        bool* did_match_rule,
+                                        bool* did_match_exception,
+                                        bool* did_match_important,
+                                        std::string* mock_data_url) {
+  // The request state is computed once and shared by every engine. Results
+  // accumulate across engines and an important rule stops checking
+  for (const auto& engine : GetEnginesToCheck()) {
+    const base::TimeTicks start_time = base::TimeTicks::Now();
+    engine.first->ShouldStartRequest(request, did_match_rule,
+                                     did_match_exception, did_match_important,
+                                     mock_data_url);
+    RecordEngineMatchTime(engine.second, base::TimeTicks::Now() - start_time);
+    if (did_match_important && *did_match_important) {
+      return;
+    }
   }
-
-  custom_filters_service()->ShouldStartRequest(
-      url, resource_type, tab_host, did_match_rule, did_match_exception,
-      did_match_important, mock_data_url);
 }
 
 absl::optional<std::string> AdBlockService::GetCspDirectives(
     const GURL& url,
     blink::mojom::ResourceType resource_type,
     const std::string& tab_host) {
-  auto csp_directives =
-      AdBlockBaseService::GetCspDirectives(url, resource_type, tab_host);
-
-  const auto regional_csp = regional_service_manager()->GetCspDirectives(
-      url, resource_type, tab_host);
-  MergeCspDirectiveInto(regional_csp, &csp_directives);
+  const AdBlockRequest request(url, resource_type, tab_host);
+  absl::optional<std::string> csp_directives = absl::nullopt;
 
-  const auto custom_csp =
-      custom_filters_service()->GetCspDirectives(url, resource_type, tab_host);
-  MergeCspDirectiveInto(custom_csp, &csp_directives);
+  for (const auto& engine : GetEnginesToCheck()) {
+    MergeCspDirectiveInto(engine.first->GetCspDirectives(request),
+                          &csp_directives);
+  }
 
   return csp_directives;
 }
 
+std::vector<
+    std::pair<scoped_refptr<AdBlockEngine>, AdBlockService::EngineType>>
+AdBlockService::GetEnginesToCheck() {
+  std::vector<std::pair<scoped_refptr<AdBlockEngine>, EngineType>> engines;
+  engines.emplace_back(GetEngine(), EngineType::kDefault);
+  for (auto& engine : regional_service_manager()->GetEngines()) {
+    engines.emplace_back(std::move(engine), EngineType::kRegional);
+  }
+  engines.emplace_back(custom_filters_service()->GetEngine(),
+                       EngineType::kCustom);
+  return engines;
+}
+
 absl::optional<base::Value> AdBlockService::UrlCosmeticResources(
     const std::string& url) {
   absl::optional<base::Value> resources =
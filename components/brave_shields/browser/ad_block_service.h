@@ -10,8 +10,11 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "base/memory/scoped_refptr.h"
+#include "base/time/time.h"
 #include "base/values.h"
 #include "brave/components/brave_shields/browser/ad_block_base_service.h"
 #include "components/keyed_service/core/keyed_service.h"
@@ -30,6 +33,8 @@ namespace brave_shields {
 
 class AdBlockRegionalServiceManager;
 class AdBlockCustomFiltersService;
+class AdBlockEngine;
+struct AdBlockRequest;
 
 const char kAdBlockResourcesFilename[] = "resources.json";
 const char kAdBlockComponentName[] = "Brave Ad Block Updater";
@@ -56,6 +61,11 @@ class AdBlockService : public AdBlockBaseService {
                           bool* did_match_exception,
                           bool* did_match_important,
                           std::string* mock_data_url) override;
+  void ShouldStartRequest(const AdBlockRequest& request,
+                          bool* did_match_rule,
+                          bool* did_match_exception,
+                          bool* did_match_important,
+                          std::string* mock_data_url);
   absl::optional<std::string> GetCspDirectives(
       const GURL& url,
       blink::mojom::ResourceType resource_type,
@@ -88,6 +98,15 @@ class AdBlockService : public AdBlockBaseService {
       const std::string& component_id,
       const std::string& component_base64_public_key);
 
+  enum class EngineType { kDefault, kRegional, kCustom };
+  static void RecordEngineMatchTime(EngineType engine_type,
+                                    base::TimeDelta match_time);
+
+  // Returns the engines a request is checked against, in the order the
+  // default, regional and custom filter services used to be checked in
+  std::vector<std::pair<scoped_refptr<AdBlockEngine>, EngineType>>
+  GetEnginesToCheck();
+
   std::unique_ptr<brave_shields::AdBlockRegionalServiceManager>
       regional_service_manager_;
   std::unique_ptr<brave_shields::AdBlockCustomFiltersService>
@@ -6,40 +6,103 @@
 #ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RECENTLY_USED_CACHE_H_
 #define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RECENTLY_USED_CACHE_H_
 
+#include <algorithm>
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "base/check.h"
 #include "base/containers/mru_cache.h"
 #include "base/synchronization/lock.h"
 
+struct HTTPSERecentlyUsedCacheStats {
+  size_t hits = 0;
+  size_t misses = 0;
+  size_t evictions = 0;
+};
+
+// An MRU cache split into |shard_count| shards, each guarded by its own lock,
+// so that lookups for different keys from different threads rarely contend.
+// Every shard holds an equal part of |size| entries.
 template <class T> class HTTPSERecentlyUsedCache {
  public:
-  explicit HTTPSERecentlyUsedCache(size_t size = 100) : data_(size) {}
+  explicit HTTPSERecentlyUsedCache(size_t size = 100, size_t shard_count = 1) {
+    DCHECK_GT(shard_count, 0u);
+    const size_t shard_size =
+        std::max<size_t>(1, (size + shard_count - 1) / shard_count);
+    for (size_t i = 0; i < shard_count; i++) {
+      shards_.push_back(std::make_unique<Shard>(shard_size));
+    }
+  }
 
   void add(const std::string& key, const T& value) {
-    base::AutoLock create(lock_);
-    data_.Put(key, value);
+    Shard* shard = GetShard(key);
+    base::AutoLock create(shard->lock);
+    if (shard->data.size() >= shard->data.max_size() &&
+        shard->data.Peek(key) == shard->data.end()) {
+      shard->stats.evictions++;
+    }
+    shard->data.Put(key, value);
   }
 
   bool get(const std::string& key, T* value) {
-    base::AutoLock create(lock_);
-    auto it = data_.Get(key);
-    if (it != data_.end()) {
+    Shard* shard = GetShard(key);
+    base::AutoLock create(shard->lock);
+    auto it = shard->data.Get(key);
+    if (it != shard->data.end()) {
+      shard->stats.hits++;
       *value = it->second;
       return true;
     }
+    shard->stats.misses++;
     return false;
   }
 
   void remove(const std::string& key) {
-    base::AutoLock lock(lock_);
-    auto it = data_.Peek(key);
-    if (it != data_.end())
-      data_.Erase(it);
+    Shard* shard = GetShard(key);
+    base::AutoLock lock(shard->lock);
+    auto it = shard->data.Peek(key);
+    if (it != shard->data.end())
+      shard->data.Erase(it);
+  }
+
+  void clear() {
+    for (const auto& shard : shards_) {
+      base::AutoLock lock(shard->lock);
+      shard->data.Clear();
+    }
+  }
+
+  // Returns the counters accumulated by every shard since the last call
+  HTTPSERecentlyUsedCacheStats TakeStats() {
+    HTTPSERecentlyUsedCacheStats stats;
+    for (const auto& shard : shards_) {
+      base::AutoLock lock(shard->lock);
+      stats.hits += shard->stats.hits;
+      stats.misses += shard->stats.misses;
+      stats.evictions += shard->stats.evictions;
+      shard->stats = HTTPSERecentlyUsedCacheStats();
+    }
+    return stats;
   }
 
  private:
-  base::MRUCache<std::string, T> data_;
-  base::Lock lock_;
+  struct Shard {
+    explicit Shard(size_t size) : data(size) {}
+
+    base::MRUCache<std::string, T> data;
+    HTTPSERecentlyUsedCacheStats stats;
+    base::Lock lock;
+  };
+
+  Shard* GetShard(const std::string& key) {
+    if (shards_.size() == 1)
+      return shards_.front().get();
+    return shards_[std::hash<std::string>()(key) % shards_.size()].get();
+  }
+
+  std::vector<std::unique_ptr<Shard>> shards_;
 };
 
 #endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RECENTLY_USED_CACHE_H_
@@ -28,3 +28,51 @@ TEST(HTTPSEverywhereRecentlyUsedCacheTest, Operations) {
   cache.remove("kD");
   ASSERT_FALSE(cache.get("kD", &v));
 }
+
+TEST(HTTPSEverywhereRecentlyUsedCacheTest, ShardedOperations) {
+  using Cache = HTTPSERecentlyUsedCache<std::string>;
+  Cache cache(64, 8);
+
+  for (int i = 0; i < 8; i++) {
+    cache.add("k" + std::to_string(i), "v" + std::to_string(i));
+  }
+
+  std::string v;
+  for (int i = 0; i < 8; i++) {
+    ASSERT_TRUE(cache.get("k" + std::to_string(i), &v));
+    ASSERT_EQ("v" + std::to_string(i), v);
+  }
+
+  cache.remove("k3");
+  ASSERT_FALSE(cache.get("k3", &v));
+
+  cache.clear();
+  ASSERT_FALSE(cache.get("k0", &v));
+}
+
+TEST(HTTPSEverywhereRecentlyUsedCacheTest, Stats) {
+  using Cache = HTTPSERecentlyUsedCache<std::string>;
+  Cache cache(2);
+
+  cache.add("kA", "vA");
+  cache.add("kB", "vB");
+  // Replacing an existing key doesn't evict.
+  cache.add("kB", "vB2");
+  cache.add("kC", "vC");
+
+  std::string v;
+  ASSERT_TRUE(cache.get("kB", &v));
+  ASSERT_TRUE(cache.get("kC", &v));
+  ASSERT_FALSE(cache.get("kA", &v));
+
+  HTTPSERecentlyUsedCacheStats stats = cache.TakeStats();
+  ASSERT_EQ(2u, stats.hits);
+  ASSERT_EQ(1u, stats.misses);
+  ASSERT_EQ(1u, stats.evictions);
+
+  // Counters are reset once taken.
+  stats = cache.TakeStats();
+  ASSERT_EQ(0u, stats.hits);
+  ASSERT_EQ(0u, stats.misses);
+  ASSERT_EQ(0u, stats.evictions);
+}
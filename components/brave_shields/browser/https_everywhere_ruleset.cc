@@ -0,0 +1,147 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/https_everywhere_ruleset.h"
+
+#include <utility>
+
+#include "base/json/json_reader.h"
+#include "base/memory/ptr_util.h"
+#include "base/values.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+#include "third_party/re2/src/re2/re2.h"
+
+namespace brave_shields {
+
+HTTPSERuleSet::Rule::Rule() = default;
+
+HTTPSERuleSet::Rule::Rule(Rule&& other) = default;
+
+HTTPSERuleSet::Rule& HTTPSERuleSet::Rule::operator=(Rule&& other) = default;
+
+HTTPSERuleSet::Rule::~Rule() = default;
+
+HTTPSERuleSet::RuleSet::RuleSet() = default;
+
+HTTPSERuleSet::RuleSet::RuleSet(RuleSet&& other) = default;
+
+HTTPSERuleSet::RuleSet& HTTPSERuleSet::RuleSet::operator=(RuleSet&& other) =
+    default;
+
+HTTPSERuleSet::RuleSet::~RuleSet() = default;
+
+HTTPSERuleSet::HTTPSERuleSet() = default;
+
+HTTPSERuleSet::~HTTPSERuleSet() = default;
+
+// static
+std::unique_ptr<HTTPSERuleSet> HTTPSERuleSet::FromJSON(
+    const std::string& json) {
+  absl::optional<base::Value> json_object = base::JSONReader::Read(json);
+  if (absl::nullopt == json_object || !json_object->is_list()) {
+    return nullptr;
+  }
+
+  auto rule_set = base::WrapUnique(new HTTPSERuleSet());
+
+  for (const auto& top_value : json_object->GetList()) {
+    if (!top_value.is_dict()) {
+      continue;
+    }
+
+    RuleSet compiled_rule_set;
+
+    const base::Value* exclusions = top_value.FindListKey("e");
+    if (exclusions) {
+      for (const auto& exclusion : exclusions->GetList()) {
+        if (!exclusion.is_dict()) {
+          continue;
+        }
+
+        const std::string* pattern = exclusion.FindStringKey("p");
+        if (!pattern) {
+          continue;
+        }
+
+        compiled_rule_set.exclusions.push_back(
+            std::make_unique<re2::RE2>(CorrectToRuleToRE2Engine(*pattern)));
+      }
+    }
+
+    const base::Value* rules = top_value.FindListKey("r");
+    if (rules) {
+      compiled_rule_set.has_rules = true;
+
+      for (const auto& rule : rules->GetList()) {
+        if (!rule.is_dict()) {
+          continue;
+        }
+
+        Rule compiled_rule;
+        if (rule.FindKey("d")) {
+          compiled_rule.is_default = true;
+          compiled_rule_set.rules.push_back(std::move(compiled_rule));
+          continue;
+        }
+
+        const std::string* from = rule.FindStringKey("f");
+        const std::string* to = rule.FindStringKey("t");
+        if (!from || !to) {
+          continue;
+        }
+
+        compiled_rule.from = std::make_unique<re2::RE2>(*from);
+        compiled_rule.to = CorrectToRuleToRE2Engine(*to);
+        compiled_rule_set.rules.push_back(std::move(compiled_rule));
+      }
+    }
+
+    rule_set->rule_sets_.push_back(std::move(compiled_rule_set));
+  }
+
+  return rule_set;
+}
+
+std::string HTTPSERuleSet::Apply(const std::string& url) const {
+  for (const auto& rule_set : rule_sets_) {
+    for (const auto& exclusion : rule_set.exclusions) {
+      if (re2::RE2::FullMatch(url, *exclusion)) {
+        return "";
+      }
+    }
+
+    if (!rule_set.has_rules) {
+      return "";
+    }
+
+    for (const auto& rule : rule_set.rules) {
+      if (rule.is_default) {
+        std::string new_url(url);
+        return new_url.insert(4, "s");
+      }
+
+      std::string new_url(url);
+      if (re2::RE2::Replace(&new_url, *rule.from, rule.to) && new_url != url) {
+        return new_url;
+      }
+    }
+  }
+
+  return "";
+}
+
+// static
+std::string HTTPSERuleSet::CorrectToRuleToRE2Engine(const std::string& to) {
+  std::string corrected_to(to);
+  size_t pos = to.find("$");
+  while (std::string::npos != pos) {
+    corrected_to[pos] = '\\';
+    pos = corrected_to.find("$");
+  }
+
+  return corrected_to;
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,73 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RULESET_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RULESET_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+
+namespace re2 {
+class RE2;
+}  // namespace re2
+
+namespace brave_shields {
+
+// The rulesets stored for an HTTPS Everywhere target, parsed from their JSON
+// representation with every exclusion and rule regular expression compiled
+// up front, so that applying them to a URL neither parses JSON nor builds
+// regular expressions.
+class HTTPSERuleSet {
+ public:
+  ~HTTPSERuleSet();
+
+  // Returns nullptr if |json| is not a list of rulesets
+  static std::unique_ptr<HTTPSERuleSet> FromJSON(const std::string& json);
+
+  // Returns the upgraded URL for |url|, or an empty string if |url| is
+  // excluded or not rewritten by any rule
+  std::string Apply(const std::string& url) const;
+
+  // Replaces '$' with '\' so that rewrite targets can be used with RE2
+  static std::string CorrectToRuleToRE2Engine(const std::string& to);
+
+ private:
+  struct Rule {
+    Rule();
+    Rule(Rule&& other);
+    Rule& operator=(Rule&& other);
+    ~Rule();
+
+    // Default rules upgrade the scheme without a regular expression
+    bool is_default = false;
+    std::unique_ptr<re2::RE2> from;
+    std::string to;
+  };
+
+  struct RuleSet {
+    RuleSet();
+    RuleSet(RuleSet&& other);
+    RuleSet& operator=(RuleSet&& other);
+    ~RuleSet();
+
+    std::vector<std::unique_ptr<re2::RE2>> exclusions;
+    // A ruleset without a list of rules stops applying any further rulesets
+    bool has_rules = false;
+    std::vector<Rule> rules;
+  };
+
+  HTTPSERuleSet();
+
+  std::vector<RuleSet> rule_sets_;
+
+  DISALLOW_COPY_AND_ASSIGN(HTTPSERuleSet);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RULESET_H_
@@ -0,0 +1,179 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/https_everywhere_ruleset.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/containers/flat_set.h"
+#include "base/containers/mru_cache.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/strings/stringprintf.h"
+#include "base/timer/lap_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+#include "third_party/leveldatabase/src/include/leveldb/db.h"
+
+// npm run test -- brave_perftests --filter=HTTPSERuleSetPerfTest*
+
+namespace brave_shields {
+
+namespace {
+
+constexpr int kWarmupRuns = 1;
+constexpr base::TimeDelta kTimeLimit = base::TimeDelta::FromSeconds(2);
+constexpr int kTimeCheckInterval = 1;
+
+// Sites in the trace, every tenth of which has a ruleset
+constexpr int kSiteCount = 10000;
+constexpr int kRuleSetInterval = 10;
+constexpr size_t kRuleSetCacheSize = 1000;
+
+constexpr char kMetricTimePerURL[] = ".time_per_url";
+
+// Returns the database keys looked up for www.site<index>.com, in the order
+// |HTTPSEverywhereService| looks them up
+std::vector<std::string> GetLookupKeys(int index) {
+  return {base::StringPrintf("com.site%d.www", index),
+          base::StringPrintf("com.site%d.*", index)};
+}
+
+std::string BuildRuleSet(int index) {
+  return base::StringPrintf(
+      R"([{"e": [{"p": "^http://www\\.site%d\\.com/plain/.*"}],)"
+      R"("r": [{"f": "^http://(www\\.)?site%d\\.com/",)"
+      R"("t": "https://$1site%d.com/"}]}])",
+      index, index, index);
+}
+
+struct TraceEntry {
+  std::string url;
+  std::vector<std::string> keys;
+};
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story) {
+  perf_test::PerfResultReporter reporter("HTTPSERuleSet.", story);
+  reporter.RegisterImportantMetric(kMetricTimePerURL, "us");
+  return reporter;
+}
+
+}  // namespace
+
+class HTTPSERuleSetPerfTest : public testing::Test {
+ protected:
+  HTTPSERuleSetPerfTest() = default;
+  ~HTTPSERuleSetPerfTest() override = default;
+
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+
+    leveldb::Options options;
+    options.create_if_missing = true;
+    leveldb::DB* db = nullptr;
+    ASSERT_TRUE(
+        leveldb::DB::Open(options, temp_dir_.GetPath().AsUTF8Unsafe(), &db)
+            .ok());
+    db_.reset(db);
+
+    std::vector<std::string> targets;
+    for (int i = 0; i < kSiteCount; i++) {
+      if (i % kRuleSetInterval == 0) {
+        const std::string target = GetLookupKeys(i).back();
+        ASSERT_TRUE(
+            db_->Put(leveldb::WriteOptions(), target, BuildRuleSet(i)).ok());
+        targets.push_back(target);
+      }
+
+      TraceEntry entry;
+      entry.url = base::StringPrintf("http://www.site%d.com/index.html", i);
+      entry.keys = GetLookupKeys(i);
+      trace_.push_back(std::move(entry));
+    }
+
+    targets_ = base::flat_set<std::string>(std::move(targets));
+  }
+
+  void Report(const std::string& story, const base::LapTimer& timer) {
+    perf_test::PerfResultReporter reporter = SetUpReporter(story);
+    reporter.AddResult(kMetricTimePerURL,
+                       timer.TimePerLap().InMicrosecondsF() / trace_.size());
+  }
+
+  base::ScopedTempDir temp_dir_;
+  std::unique_ptr<leveldb::DB> db_;
+  base::flat_set<std::string> targets_;
+  std::vector<TraceEntry> trace_;
+};
+
+// Looks up every key in the database and parses and compiles the ruleset for
+// every hit
+TEST_F(HTTPSERuleSetPerfTest, LevelDB) {
+  base::LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    for (const auto& entry : trace_) {
+      for (const auto& key : entry.keys) {
+        std::string value;
+        if (!db_->Get(leveldb::ReadOptions(), key, &value).ok()) {
+          continue;
+        }
+
+        std::unique_ptr<HTTPSERuleSet> rule_set =
+            HTTPSERuleSet::FromJSON(value);
+        if (rule_set && !rule_set->Apply(entry.url).empty()) {
+          break;
+        }
+      }
+    }
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+
+  Report("leveldb", timer);
+}
+
+// Looks up every key in the in-memory target index and applies cached
+// compiled rulesets
+TEST_F(HTTPSERuleSetPerfTest, Compiled) {
+  base::HashingMRUCache<std::string, std::unique_ptr<HTTPSERuleSet>> rule_sets(
+      kRuleSetCacheSize);
+
+  base::LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    for (const auto& entry : trace_) {
+      for (const auto& key : entry.keys) {
+        if (targets_.find(key) == targets_.end()) {
+          continue;
+        }
+
+        auto iter = rule_sets.Get(key);
+        if (iter == rule_sets.end()) {
+          std::string value;
+          if (!db_->Get(leveldb::ReadOptions(), key, &value).ok()) {
+            continue;
+          }
+
+          std::unique_ptr<HTTPSERuleSet> rule_set =
+              HTTPSERuleSet::FromJSON(value);
+          if (!rule_set) {
+            continue;
+          }
+
+          iter = rule_sets.Put(key, std::move(rule_set));
+        }
+
+        if (!iter->second->Apply(entry.url).empty()) {
+          break;
+        }
+      }
+    }
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+
+  Report("compiled", timer);
+}
+
+}  // namespace brave_shields
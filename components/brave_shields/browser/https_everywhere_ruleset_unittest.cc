@@ -0,0 +1,63 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/https_everywhere_ruleset.h"
+
+#include <memory>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace brave_shields {
+
+TEST(HTTPSERuleSetTest, InvalidJSON) {
+  EXPECT_FALSE(HTTPSERuleSet::FromJSON("not json"));
+  EXPECT_FALSE(HTTPSERuleSet::FromJSON("{\"r\": []}"));
+}
+
+TEST(HTTPSERuleSetTest, RewritesURL) {
+  std::unique_ptr<HTTPSERuleSet> rule_set = HTTPSERuleSet::FromJSON(
+      R"([{"r": [{"f": "^http://(www\\.)?example\\.com/",
+                  "t": "https://$1example.com/"}]}])");
+  ASSERT_TRUE(rule_set);
+
+  EXPECT_EQ("https://www.example.com/index.html",
+            rule_set->Apply("http://www.example.com/index.html"));
+  EXPECT_EQ("", rule_set->Apply("http://other.example.com/"));
+}
+
+TEST(HTTPSERuleSetTest, DefaultRule) {
+  std::unique_ptr<HTTPSERuleSet> rule_set =
+      HTTPSERuleSet::FromJSON(R"([{"r": [{"d": 1}]}])");
+  ASSERT_TRUE(rule_set);
+
+  EXPECT_EQ("https://example.com/", rule_set->Apply("http://example.com/"));
+}
+
+TEST(HTTPSERuleSetTest, Exclusion) {
+  std::unique_ptr<HTTPSERuleSet> rule_set = HTTPSERuleSet::FromJSON(
+      R"([{"e": [{"p": "^http://example\\.com/plain/.*"}],
+           "r": [{"d": 1}]}])");
+  ASSERT_TRUE(rule_set);
+
+  EXPECT_EQ("", rule_set->Apply("http://example.com/plain/index.html"));
+  EXPECT_EQ("https://example.com/secure/",
+            rule_set->Apply("http://example.com/secure/"));
+}
+
+TEST(HTTPSERuleSetTest, RuleSetWithoutRulesStopsLookup) {
+  std::unique_ptr<HTTPSERuleSet> rule_set =
+      HTTPSERuleSet::FromJSON(R"([{}, {"r": [{"d": 1}]}])");
+  ASSERT_TRUE(rule_set);
+
+  EXPECT_EQ("", rule_set->Apply("http://example.com/"));
+}
+
+TEST(HTTPSERuleSetTest, CorrectToRuleToRE2Engine) {
+  EXPECT_EQ("https://\\1example.com/\\2",
+            HTTPSERuleSet::CorrectToRuleToRE2Engine(
+                "https://$1example.com/$2"));
+}
+
+}  // namespace brave_shields
@@ -12,15 +12,16 @@
 
 #include "base/base_paths.h"
 #include "base/bind.h"
-#include "base/json/json_reader.h"
+#include "base/feature_list.h"
 #include "base/logging.h"
 #include "base/macros.h"
 #include "base/memory/ptr_util.h"
+#include "base/metrics/histogram_macros.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/threading/scoped_blocking_call.h"
 #include "base/values.h"
+#include "brave/components/brave_shields/common/features.h"
 #include "third_party/leveldatabase/src/include/leveldb/db.h"
-#include "third_party/re2/src/re2/re2.h"
 #include "third_party/zlib/google/zip.h"
 
 #define DAT_FILE "httpse.leveldb.zip"
@@ -30,6 +31,13 @@
 
 namespace {
 
+constexpr size_t kRuleSetCacheSize = 1000;
+constexpr size_t kRecentlyUsedCacheSize = 1024;
+constexpr size_t kNoRuleSetHostsCacheSize = 4096;
+constexpr size_t kCacheShardCount = 16;
+// Cache metrics are recorded after this many lookups on the service sequence
+constexpr size_t kCacheMetricsInterval = 1000;
+
 std::vector<std::string> Split(const std::string& s, char delim) {
   std::stringstream ss(s);
   std::string item;
@@ -100,7 +108,12 @@ HTTPSEverywhereService::g_https_everywhere_component_base64_public_key_(
 HTTPSEverywhereService::HTTPSEverywhereService(
     BraveComponent::Delegate* delegate)
     : BaseBraveShieldsService(delegate),
-      level_db_(nullptr) {
+      recently_used_cache_(kRecentlyUsedCacheSize, kCacheShardCount),
+      no_rule_set_hosts_(kNoRuleSetHostsCacheSize, kCacheShardCount),
+      use_no_rule_set_hosts_(base::FeatureList::IsEnabled(
+          features::kBraveHTTPSENegativeHostCache)),
+      level_db_(nullptr),
+      rule_sets_(kRuleSetCacheSize) {
   DETACH_FROM_SEQUENCE(sequence_checker_);
 }
 
@@ -141,6 +154,53 @@ void HTTPSEverywhereService::InitDB(const base::FilePath& install_dir) {
     CloseDatabase();
     return;
   }
+
+  InitTargets();
+}
+
+void HTTPSEverywhereService::InitTargets() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(level_db_);
+
+  std::vector<std::string> targets;
+  std::unique_ptr<leveldb::Iterator> iterator(
+      level_db_->NewIterator(leveldb::ReadOptions()));
+  for (iterator->SeekToFirst(); iterator->Valid(); iterator->Next()) {
+    targets.push_back(iterator->key().ToString());
+  }
+
+  if (!iterator->status().ok()) {
+    LOG(ERROR) << "Failed to read HTTPS Everywhere targets, error: "
+               << iterator->status().ToString();
+    CloseDatabase();
+    return;
+  }
+
+  targets_ = base::flat_set<std::string>(std::move(targets));
+  no_rule_set_hosts_.clear();
+}
+
+const HTTPSERuleSet* HTTPSEverywhereService::GetRuleSet(
+    const std::string& target) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  if (targets_.find(target) == targets_.end()) {
+    return nullptr;
+  }
+
+  auto iter = rule_sets_.Get(target);
+  if (iter != rule_sets_.end()) {
+    return iter->second.get();
+  }
+
+  std::unique_ptr<HTTPSERuleSet> rule_set =
+      HTTPSERuleSet::FromJSON(leveldbGet(level_db_, target));
+  if (!rule_set) {
+    return nullptr;
+  }
+
+  iter = rule_sets_.Put(target, std::move(rule_set));
+  return iter->second.get();
 }
 
 void HTTPSEverywhereService::OnComponentReady(
@@ -156,6 +216,34 @@ bool HTTPSEverywhereService::GetHTTPSURL(
     const GURL* url,
     const uint64_t& request_identifier,
     std::string* new_url) {
+  if (!ShouldHTTPSERedirect(request_identifier)) {
+    return false;
+  }
+  if (!LookupHTTPSURL(url, new_url)) {
+    return false;
+  }
+  AddHTTPSEUrlToRedirectList(request_identifier);
+  return true;
+}
+
+bool HTTPSEverywhereService::GetHTTPSURLFromCacheOnly(
+    const GURL* url,
+    const uint64_t& request_identifier,
+    std::string* cached_url) {
+  if (!ShouldHTTPSERedirect(request_identifier)) {
+    return false;
+  }
+  if (!LookupHTTPSURLFromCacheOnly(url, cached_url)) {
+    return false;
+  }
+  if (!cached_url->empty()) {
+    AddHTTPSEUrlToRedirectList(request_identifier);
+  }
+  return true;
+}
+
+bool HTTPSEverywhereService::LookupHTTPSURL(const GURL* url,
+                                            std::string* new_url) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
 
   if (!url->is_valid())
@@ -164,15 +252,20 @@ bool HTTPSEverywhereService::GetHTTPSURL(
   if (!IsInitialized() || !level_db_ || url->scheme() == url::kHttpsScheme) {
     return false;
   }
-  if (!ShouldHTTPSERedirect(request_identifier)) {
-    return false;
+
+  if (++lookups_since_metrics_ >= kCacheMetricsInterval) {
+    RecordCacheMetrics();
   }
 
   if (recently_used_cache_.get(url->spec(), new_url)) {
-    AddHTTPSEUrlToRedirectList(request_identifier);
     return true;
   }
 
+  bool unused;
+  if (use_no_rule_set_hosts_ && no_rule_set_hosts_.get(url->host(), &unused)) {
+    return false;
+  }
+
   GURL candidate_url(*url);
   if (g_ignore_port_for_test_ && candidate_url.has_port()) {
     GURL::Replacements replacements;
@@ -182,24 +275,27 @@ bool HTTPSEverywhereService::GetHTTPSURL(
 
   const std::vector<std::string> domains =
       ExpandDomainForLookup(candidate_url.host());
-  for (auto domain : domains) {
-    std::string value = leveldbGet(level_db_, domain);
-    if (!value.empty()) {
-      *new_url = ApplyHTTPSRule(candidate_url.spec(), value);
+  bool has_rule_sets = false;
+  for (const auto& domain : domains) {
+    const HTTPSERuleSet* rule_set = GetRuleSet(domain);
+    if (rule_set) {
+      has_rule_sets = true;
+      *new_url = rule_set->Apply(candidate_url.spec());
       if (0 != new_url->length()) {
         recently_used_cache_.add(candidate_url.spec(), *new_url);
-        AddHTTPSEUrlToRedirectList(request_identifier);
         return true;
       }
     }
   }
   recently_used_cache_.remove(candidate_url.spec());
+  if (use_no_rule_set_hosts_ && !has_rule_sets) {
+    no_rule_set_hosts_.add(candidate_url.host(), true);
+  }
   return false;
 }
 
-bool HTTPSEverywhereService::GetHTTPSURLFromCacheOnly(
+bool HTTPSEverywhereService::LookupHTTPSURLFromCacheOnly(
     const GURL* url,
-    const uint64_t& request_identifier,
     std::string* cached_url) {
   if (!url->is_valid())
     return false;
@@ -207,17 +303,59 @@ bool HTTPSEverywhereService::GetHTTPSURLFromCacheOnly(
   if (!IsInitialized() || url->scheme() == url::kHttpsScheme) {
     return false;
   }
-  if (!ShouldHTTPSERedirect(request_identifier)) {
-    return false;
-  }
 
   if (recently_used_cache_.get(url->spec(), cached_url)) {
-    AddHTTPSEUrlToRedirectList(request_identifier);
+    return true;
+  }
+
+  // Hosts without rulesets are never upgraded, so the lookup is complete
+  bool unused;
+  if (use_no_rule_set_hosts_ && no_rule_set_hosts_.get(url->host(), &unused)) {
+    cached_url->clear();
     return true;
   }
   return false;
 }
 
+bool HTTPSEverywhereService::RecordHTTPSERedirect(
+    const uint64_t& request_identifier) {
+  if (!ShouldHTTPSERedirect(request_identifier)) {
+    return false;
+  }
+  AddHTTPSEUrlToRedirectList(request_identifier);
+  return true;
+}
+
+void HTTPSEverywhereService::RecordCacheMetrics() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  lookups_since_metrics_ = 0;
+
+  const HTTPSERecentlyUsedCacheStats stats = recently_used_cache_.TakeStats();
+  const size_t lookups = stats.hits + stats.misses;
+  if (lookups > 0) {
+    UMA_HISTOGRAM_PERCENTAGE("Brave.HTTPSE.RecentlyUsedCacheHitRate",
+                             stats.hits * 100 / lookups);
+    UMA_HISTOGRAM_PERCENTAGE("Brave.HTTPSE.RecentlyUsedCacheMissRate",
+                             stats.misses * 100 / lookups);
+  }
+  UMA_HISTOGRAM_COUNTS_10000("Brave.HTTPSE.RecentlyUsedCacheEvictions",
+                             stats.evictions);
+
+  if (!use_no_rule_set_hosts_) {
+    return;
+  }
+
+  const HTTPSERecentlyUsedCacheStats host_stats =
+      no_rule_set_hosts_.TakeStats();
+  const size_t host_lookups = host_stats.hits + host_stats.misses;
+  if (host_lookups > 0) {
+    UMA_HISTOGRAM_PERCENTAGE("Brave.HTTPSE.NoRuleSetHostsCacheHitRate",
+                             host_stats.hits * 100 / host_lookups);
+  }
+  UMA_HISTOGRAM_COUNTS_10000("Brave.HTTPSE.NoRuleSetHostsCacheEvictions",
+                             host_stats.evictions);
+}
+
 bool HTTPSEverywhereService::ShouldHTTPSERedirect(
     const uint64_t& request_identifier) {
   base::AutoLock auto_lock(httpse_get_urls_redirects_count_mutex_);
@@ -263,113 +401,17 @@ void HTTPSEverywhereService::AddHTTPSEUrlToRedirectList(
 std::string HTTPSEverywhereService::ApplyHTTPSRule(
     const std::string& originalUrl,
     const std::string& rule) {
-  absl::optional<base::Value> json_object = base::JSONReader::Read(rule);
-  if (absl::nullopt == json_object || !json_object->is_list()) {
+  std::unique_ptr<HTTPSERuleSet> rule_set = HTTPSERuleSet::FromJSON(rule);
+  if (!rule_set) {
     return "";
   }
 
-  base::Value::ConstListView topValues = json_object->GetList();
-  for (auto it = topValues.cbegin(); it != topValues.cend(); ++it) {
-    if (!it->is_dict()) {
-      continue;
-    }
-    const base::DictionaryValue* childTopDictionary = nullptr;
-    it->GetAsDictionary(&childTopDictionary);
-    if (nullptr == childTopDictionary) {
-      continue;
-    }
-
-    const base::Value* exclusion = nullptr;
-    if (childTopDictionary->Get("e", &exclusion)) {
-      const base::ListValue* eValues = nullptr;
-      exclusion->GetAsList(&eValues);
-      if (nullptr != eValues) {
-        for (size_t j = 0; j < eValues->GetSize(); ++j) {
-          const base::Value* pValue = nullptr;
-          if (!eValues->Get(j, &pValue)) {
-            continue;
-          }
-          const base::DictionaryValue* pDictionary = nullptr;
-          pValue->GetAsDictionary(&pDictionary);
-          if (nullptr == pDictionary) {
-            continue;
-          }
-          const base::Value* patternValue = nullptr;
-          if (!pDictionary->Get("p", &patternValue)) {
-            continue;
-          }
-          std::string pattern;
-          if (!patternValue->GetAsString(&pattern)) {
-            continue;
-          }
-          pattern = CorrecttoRuleToRE2Engine(pattern);
-          if (RE2::FullMatch(originalUrl, pattern)) {
-            return "";
-          }
-        }
-      }
-    }
-
-    const base::Value* rules = nullptr;
-    if (!childTopDictionary->Get("r", &rules)) {
-      return "";
-    }
-    const base::ListValue* rValues = nullptr;
-    rules->GetAsList(&rValues);
-    if (nullptr == rValues) {
-      return "";
-    }
-
-    for (size_t j = 0; j < rValues->GetSize(); ++j) {
-      const base::Value* pValue = nullptr;
-      if (!rValues->Get(j, &pValue)) {
-        continue;
-      }
-      const base::DictionaryValue* pDictionary = nullptr;
-      pValue->GetAsDictionary(&pDictionary);
-      if (nullptr == pDictionary) {
-        continue;
-      }
-      const base::Value* patternValue = nullptr;
-      if (pDictionary->Get("d", &patternValue)) {
-        std::string newUrl(originalUrl);
-        return newUrl.insert(4, "s");
-      }
-
-      const base::Value* from_value = nullptr;
-      const base::Value* to_value = nullptr;
-      if (!pDictionary->Get("f", &from_value) ||
-          !pDictionary->Get("t", &to_value)) {
-        continue;
-      }
-      std::string from, to;
-      if (!from_value->GetAsString(&from) ||
-          !to_value->GetAsString(&to)) {
-        continue;
-      }
-
-      to = CorrecttoRuleToRE2Engine(to);
-      std::string newUrl(originalUrl);
-      RE2 regExp(from);
-
-      if (RE2::Replace(&newUrl, regExp, to) && newUrl != originalUrl) {
-        return newUrl;
-      }
-    }
-  }
-  return "";
+  return rule_set->Apply(originalUrl);
 }
 
 std::string HTTPSEverywhereService::CorrecttoRuleToRE2Engine(
     const std::string& to) {
-  std::string correctedto(to);
-  size_t pos = to.find("$");
-  while (std::string::npos != pos) {
-    correctedto[pos] = '\\';
-    pos = correctedto.find("$");
-  }
-
-  return correctedto;
+  return HTTPSERuleSet::CorrectToRuleToRE2Engine(to);
 }
 
 void HTTPSEverywhereService::CloseDatabase() {
@@ -378,6 +420,9 @@ void HTTPSEverywhereService::CloseDatabase() {
     delete level_db_;
     level_db_ = nullptr;
   }
+
+  targets_.clear();
+  rule_sets_.Clear();
 }
 
 // static
@@ -10,12 +10,15 @@
 #include <string>
 #include <vector>
 
+#include "base/containers/flat_set.h"
+#include "base/containers/mru_cache.h"
 #include "base/files/file_path.h"
 #include "base/memory/weak_ptr.h"
 #include "base/sequence_checker.h"
 #include "base/synchronization/lock.h"
 #include "brave/components/brave_shields/browser/base_brave_shields_service.h"
 #include "brave/components/brave_shields/browser/https_everywhere_recently_used_cache.h"
+#include "brave/components/brave_shields/browser/https_everywhere_ruleset.h"
 
 namespace leveldb {
 class DB;
@@ -51,9 +54,20 @@ class HTTPSEverywhereService : public BaseBraveShieldsService,
   bool GetHTTPSURL(const GURL* url,
                    const uint64_t& request_id,
                    std::string* new_url);
+  // Returns true if the lookup was resolved from the caches, in which case an
+  // empty |cached_url| means that |url| is not upgraded
   bool GetHTTPSURLFromCacheOnly(const GURL* url,
                                 const uint64_t& request_id,
                                 std::string* cached_url);
+  // Like |GetHTTPSURL| and |GetHTTPSURLFromCacheOnly|, but without counting
+  // the upgrade as a redirect of the request, so that the lookup can start
+  // before it is known whether the upgrade is applied. The caller records it
+  // with |RecordHTTPSERedirect| once applied.
+  bool LookupHTTPSURL(const GURL* url, std::string* new_url);
+  bool LookupHTTPSURLFromCacheOnly(const GURL* url, std::string* cached_url);
+  // Counts an upgrade applied to |request_id|. Returns false, without counting
+  // it, if the request was already redirected too many times.
+  bool RecordHTTPSERedirect(const uint64_t& request_id);
 
  protected:
   bool Init() override;
@@ -80,12 +94,30 @@ class HTTPSEverywhereService : public BaseBraveShieldsService,
   void CloseDatabase();
 
   void InitDB(const base::FilePath& install_dir);
+  void InitTargets();
+  void RecordCacheMetrics();
+
+  // Returns the compiled rulesets for |target|, or nullptr if there are none
+  const HTTPSERuleSet* GetRuleSet(const std::string& target);
 
   base::Lock httpse_get_urls_redirects_count_mutex_;
   std::vector<HTTPSE_REDIRECTS_COUNT_ST> httpse_urls_redirects_count_;
   HTTPSERecentlyUsedCache<std::string> recently_used_cache_;
+  // Hosts for which no target has rulesets
+  HTTPSERecentlyUsedCache<bool> no_rule_set_hosts_;
+  const bool use_no_rule_set_hosts_;
+  size_t lookups_since_metrics_ = 0;
   leveldb::DB* level_db_;
 
+  // Every target stored in the database, so that hosts without rulesets are
+  // looked up in memory rather than in the database
+  base::flat_set<std::string> targets_;
+
+  // Recently applied rulesets, parsed and compiled once rather than for
+  // every lookup
+  base::HashingMRUCache<std::string, std::unique_ptr<HTTPSERuleSet>>
+      rule_sets_;
+
   SEQUENCE_CHECKER(sequence_checker_);
   DISALLOW_COPY_AND_ASSIGN(HTTPSEverywhereService);
 };
@@ -0,0 +1,91 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/registrable_domain_cache.h"
+
+#include "base/containers/mru_cache.h"
+#include "base/no_destructor.h"
+#include "base/synchronization/lock.h"
+#include "net/base/registry_controlled_domains/registry_controlled_domain.h"
+
+namespace brave_shields {
+
+namespace {
+
+constexpr size_t kCacheSize = 256;
+
+// Lookups come from the UI thread and the shields task runner, so the cache is
+// guarded by a lock
+class Cache {
+ public:
+  Cache() : entries_(kCacheSize) {}
+
+  bool Get(const std::string& host, std::string* domain) {
+    base::AutoLock lock(lock_);
+    auto it = entries_.Get(host);
+    if (it == entries_.end()) {
+      return false;
+    }
+    *domain = it->second;
+    return true;
+  }
+
+  void Put(const std::string& host, const std::string& domain) {
+    base::AutoLock lock(lock_);
+    entries_.Put(host, domain);
+  }
+
+  void Clear() {
+    base::AutoLock lock(lock_);
+    entries_.Clear();
+  }
+
+ private:
+  base::Lock lock_;
+  base::MRUCache<std::string, std::string> entries_;
+};
+
+Cache* GetCache() {
+  static base::NoDestructor<Cache> cache;
+  return cache.get();
+}
+
+}  // namespace
+
+std::string GetRegistrableDomain(const std::string& host) {
+  if (host.empty()) {
+    return std::string();
+  }
+
+  std::string domain;
+  if (GetCache()->Get(host, &domain)) {
+    return domain;
+  }
+
+  domain = net::registry_controlled_domains::GetDomainAndRegistry(
+      host, net::registry_controlled_domains::INCLUDE_PRIVATE_REGISTRIES);
+  GetCache()->Put(host, domain);
+  return domain;
+}
+
+bool SameRegistrableDomainOrHost(const std::string& host1,
+                                 const std::string& host2) {
+  if (host1.empty() || host2.empty()) {
+    return false;
+  }
+
+  if (host1 == host2) {
+    return true;
+  }
+
+  const std::string domain1 = GetRegistrableDomain(host1);
+  return !domain1.empty() && domain1 == GetRegistrableDomain(host2);
+}
+
+void ClearRegistrableDomainCacheForTesting() {
+  GetCache()->Clear();
+}
+
+}  // namespace brave_shields
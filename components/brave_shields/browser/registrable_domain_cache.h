@@ -0,0 +1,28 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_REGISTRABLE_DOMAIN_CACHE_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_REGISTRABLE_DOMAIN_CACHE_H_
+
+#include <string>
+
+namespace brave_shields {
+
+// Returns the registrable domain (eTLD+1) of |host|, including private
+// registries, or an empty string if |host| has none. Results are kept in a
+// small per-process LRU, since every request looks up the same few hosts from
+// several shields helpers and ad-block engines.
+std::string GetRegistrableDomain(const std::string& host);
+
+// Equivalent to net::registry_controlled_domains::SameDomainOrHost with
+// INCLUDE_PRIVATE_REGISTRIES, backed by |GetRegistrableDomain|.
+bool SameRegistrableDomainOrHost(const std::string& host1,
+                                 const std::string& host2);
+
+void ClearRegistrableDomainCacheForTesting();
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_REGISTRABLE_DOMAIN_CACHE_H_
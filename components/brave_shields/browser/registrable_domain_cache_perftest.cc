@@ -0,0 +1,150 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/registrable_domain_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "base/strings/stringprintf.h"
+#include "base/timer/lap_timer.h"
+#include "net/base/registry_controlled_domains/registry_controlled_domain.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+#include "url/gurl.h"
+
+// npm run test -- brave_perftests --filter=RegistrableDomainCachePerfTest*
+
+namespace brave_shields {
+
+namespace {
+
+constexpr int kWarmupRuns = 1;
+constexpr base::TimeDelta kTimeLimit = base::TimeDelta::FromSeconds(2);
+constexpr int kTimeCheckInterval = 1;
+
+// Ad-block engines checked for every request: default, one regional list
+// and custom filters
+constexpr int kEngineCount = 3;
+constexpr int kPageCount = 20;
+constexpr int kRequestsPerPage = 50;
+
+constexpr char kMetricTimePerRequest[] = ".time_per_request";
+
+struct Request {
+  GURL url;
+  GURL initiator_url;
+};
+
+// Subresource requests for a few pages, each loading first-party assets and
+// third-party resources from a handful of hosts
+std::vector<Request> BuildRequests() {
+  std::vector<Request> requests;
+  for (int page = 0; page < kPageCount; page++) {
+    const GURL initiator_url(
+        base::StringPrintf("https://www.site%d.com/", page));
+    for (int i = 0; i < kRequestsPerPage; i++) {
+      Request request;
+      request.initiator_url = initiator_url;
+      if (i % 2 == 0) {
+        request.url = GURL(
+            base::StringPrintf("https://static.site%d.com/%d.js", page, i));
+      } else {
+        request.url = GURL(base::StringPrintf(
+            "https://cdn%d.thirdparty.co.uk/%d.js", i % 5, i));
+      }
+      requests.push_back(request);
+    }
+  }
+  return requests;
+}
+
+bool SameDomainOrHost(const GURL& url1, const GURL& url2) {
+  return net::registry_controlled_domains::SameDomainOrHost(
+      url1, url2, net::registry_controlled_domains::INCLUDE_PRIVATE_REGISTRIES);
+}
+
+std::string GetDomainAndRegistry(const std::string& host) {
+  return net::registry_controlled_domains::GetDomainAndRegistry(
+      host, net::registry_controlled_domains::INCLUDE_PRIVATE_REGISTRIES);
+}
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story) {
+  perf_test::PerfResultReporter reporter("RegistrableDomainCache.", story);
+  reporter.RegisterImportantMetric(kMetricTimePerRequest, "us");
+  return reporter;
+}
+
+}  // namespace
+
+class RegistrableDomainCachePerfTest : public testing::Test {
+ protected:
+  RegistrableDomainCachePerfTest() : requests_(BuildRequests()) {}
+  ~RegistrableDomainCachePerfTest() override = default;
+
+  void Report(const std::string& story, const base::LapTimer& timer) {
+    perf_test::PerfResultReporter reporter = SetUpReporter(story);
+    reporter.AddResult(
+        kMetricTimePerRequest,
+        timer.TimePerLap().InMicrosecondsF() / requests_.size());
+  }
+
+  const std::vector<Request> requests_;
+};
+
+// The registry lookups made for every request before they were memoized: the
+// site-hacks and ad-block third-party checks, and the domain resolver called
+// by every ad-block engine for the request and initiator hosts
+TEST_F(RegistrableDomainCachePerfTest, PerLookup) {
+  size_t third_party_count = 0;
+
+  base::LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    for (const auto& request : requests_) {
+      if (!SameDomainOrHost(request.initiator_url, request.url)) {
+        third_party_count++;
+      }
+      if (!SameDomainOrHost(request.url, request.initiator_url)) {
+        third_party_count++;
+      }
+      for (int i = 0; i < kEngineCount; i++) {
+        GetDomainAndRegistry(request.url.host());
+        GetDomainAndRegistry(request.initiator_url.host());
+      }
+    }
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+
+  EXPECT_GT(third_party_count, 0u);
+  Report("per_lookup", timer);
+}
+
+// The same lookups with the third-party bit computed once per request and
+// registrable domains served from the per-process cache
+TEST_F(RegistrableDomainCachePerfTest, Memoized) {
+  ClearRegistrableDomainCacheForTesting();
+  size_t third_party_count = 0;
+
+  base::LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    for (const auto& request : requests_) {
+      const bool is_third_party = !SameRegistrableDomainOrHost(
+          request.url.host(), request.initiator_url.host());
+      if (is_third_party) {
+        third_party_count += 2;
+      }
+      for (int i = 0; i < kEngineCount; i++) {
+        GetRegistrableDomain(request.url.host());
+        GetRegistrableDomain(request.initiator_url.host());
+      }
+    }
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+
+  EXPECT_GT(third_party_count, 0u);
+  Report("memoized", timer);
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,51 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/registrable_domain_cache.h"
+
+#include <string>
+
+#include "net/base/registry_controlled_domains/registry_controlled_domain.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace brave_shields {
+
+class RegistrableDomainCacheTest : public testing::Test {
+ protected:
+  void SetUp() override { ClearRegistrableDomainCacheForTesting(); }
+};
+
+TEST_F(RegistrableDomainCacheTest, GetRegistrableDomain) {
+  EXPECT_EQ("brave.com", GetRegistrableDomain("www.brave.com"));
+  // Cached results are the same
+  EXPECT_EQ("brave.com", GetRegistrableDomain("www.brave.com"));
+  // Private registries are included
+  EXPECT_EQ("brave.github.io", GetRegistrableDomain("brave.github.io"));
+  EXPECT_EQ("", GetRegistrableDomain("127.0.0.1"));
+  EXPECT_EQ("", GetRegistrableDomain("com"));
+  EXPECT_EQ("", GetRegistrableDomain(""));
+}
+
+TEST_F(RegistrableDomainCacheTest, MatchesSameDomainOrHost) {
+  const char* kHosts[] = {"www.brave.com", "cdn.brave.com", "brave.com",
+                          "example.com",   "brave.github.io",
+                          "other.github.io", "127.0.0.1", "localhost", ""};
+
+  for (const char* host1 : kHosts) {
+    for (const char* host2 : kHosts) {
+      const GURL url1(std::string("https://") + host1 + "/");
+      const GURL url2(std::string("https://") + host2 + "/");
+      EXPECT_EQ(net::registry_controlled_domains::SameDomainOrHost(
+                    url1, url2,
+                    net::registry_controlled_domains::
+                        INCLUDE_PRIVATE_REGISTRIES),
+                SameRegistrableDomainOrHost(url1.host(), url2.host()))
+          << host1 << " " << host2;
+    }
+  }
+}
+
+}  // namespace brave_shields
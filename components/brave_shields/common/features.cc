@@ -37,6 +37,10 @@ const base::Feature kBraveDomainBlock{"BraveDomainBlock",
 // potentially blocked by Brave Shields.
 const base::Feature kBraveExtensionNetworkBlocking{
     "BraveExtensionNetworkBlocking", base::FEATURE_DISABLED_BY_DEFAULT};
+// When enabled, HTTPS Everywhere will remember hosts without any rulesets, so
+// that requests to them are resolved without looking up rulesets.
+const base::Feature kBraveHTTPSENegativeHostCache{
+    "BraveHTTPSENegativeHostCache", base::FEATURE_ENABLED_BY_DEFAULT};
 
 }  // namespace features
 }  // namespace brave_shields
@@ -5,6 +5,8 @@
 
 #include "brave/components/brave_wallet/browser/eth_tx_state_manager.h"
 
+#include "base/auto_reset.h"
+#include "base/bind.h"
 #include "base/guid.h"
 #include "base/logging.h"
 #include "base/util/values/values_util.h"
@@ -18,7 +20,13 @@
 
 namespace brave_wallet {
 
-EthTxStateManager::EthTxStateManager(PrefService* prefs) : prefs_(prefs) {}
+EthTxStateManager::EthTxStateManager(PrefService* prefs) : prefs_(prefs) {
+  pref_change_registrar_.Init(prefs_);
+  pref_change_registrar_.Add(
+      kBraveWalletTransactions,
+      base::BindRepeating(&EthTxStateManager::OnTransactionsPrefChanged,
+                          base::Unretained(this)));
+}
 EthTxStateManager::~EthTxStateManager() = default;
 
 EthTxStateManager::TxMeta::TxMeta() = default;
@@ -147,6 +155,17 @@ absl::optional<EthTxStateManager::TxMeta> EthTxStateManager::ValueToTxMeta(
 }
 
 void EthTxStateManager::AddOrUpdateTx(const TxMeta& meta) {
+  EnsureLoaded();
+  auto iter = txs_.find(meta.id);
+  if (iter != txs_.end()) {
+    RemoveFromIndexes(iter->first, iter->second);
+    iter->second = meta;
+  } else {
+    iter = txs_.emplace(meta.id, meta).first;
+  }
+  AddToIndexes(iter->first, iter->second);
+
+  base::AutoReset<bool> updating_pref(&updating_pref_, true);
   DictionaryPrefUpdate update(prefs_, kBraveWalletTransactions);
   base::DictionaryValue* dict = update.Get();
   dict->SetKey(meta.id, TxMetaToValue(meta));
@@ -155,37 +174,70 @@ void EthTxStateManager::AddOrUpdateTx(const TxMeta& meta) {
 bool EthTxStateManager::GetTx(const std::string& id, TxMeta* meta) {
   if (!meta)
     return false;
-  const base::DictionaryValue* dict =
-      prefs_->GetDictionary(kBraveWalletTransactions);
-  if (!dict)
-    return false;
-  const base::Value* value = dict->FindKey(id);
-  if (!value)
-    return false;
-
-  absl::optional<TxMeta> meta_from_value = ValueToTxMeta(*value);
-  if (!meta_from_value)
+  EnsureLoaded();
+  auto iter = txs_.find(id);
+  if (iter == txs_.end())
     return false;
 
-  *meta = *meta_from_value;
+  *meta = iter->second;
 
   return true;
 }
 
 void EthTxStateManager::DeleteTx(const std::string& id) {
+  EnsureLoaded();
+  auto iter = txs_.find(id);
+  if (iter != txs_.end()) {
+    RemoveFromIndexes(iter->first, iter->second);
+    txs_.erase(iter);
+  }
+
+  base::AutoReset<bool> updating_pref(&updating_pref_, true);
   DictionaryPrefUpdate update(prefs_, kBraveWalletTransactions);
   base::DictionaryValue* dict = update.Get();
   dict->RemoveKey(id);
 }
 
 void EthTxStateManager::WipeTxs() {
+  txs_.clear();
+  ids_by_status_.clear();
+  ids_by_status_and_from_.clear();
+  loaded_ = true;
+
+  base::AutoReset<bool> updating_pref(&updating_pref_, true);
   prefs_->ClearPref(kBraveWalletTransactions);
 }
 
 std::vector<EthTxStateManager::TxMeta>
 EthTxStateManager::GetTransactionsByStatus(TransactionStatus status,
                                            absl::optional<EthAddress> from) {
+  EnsureLoaded();
   std::vector<EthTxStateManager::TxMeta> result;
+  const std::set<std::string>* ids = nullptr;
+  if (from.has_value()) {
+    auto iter = ids_by_status_and_from_.find({status, from->ToHex()});
+    if (iter != ids_by_status_and_from_.end())
+      ids = &iter->second;
+  } else {
+    auto iter = ids_by_status_.find(status);
+    if (iter != ids_by_status_.end())
+      ids = &iter->second;
+  }
+  if (!ids)
+    return result;
+
+  result.reserve(ids->size());
+  for (const auto& id : *ids) {
+    result.push_back(txs_.at(id));
+  }
+  return result;
+}
+
+void EthTxStateManager::EnsureLoaded() {
+  if (loaded_)
+    return;
+  loaded_ = true;
+
   const base::DictionaryValue* value =
       prefs_->GetDictionary(kBraveWalletTransactions);
   for (base::DictionaryValue::Iterator iter(*value); !iter.IsAtEnd();
@@ -194,13 +246,44 @@ EthTxStateManager::GetTransactionsByStatus(TransactionStatus status,
     if (!meta) {
       continue;
     }
-    if (meta->status == status) {
-      if (from.has_value() && meta->from != *from)
-        continue;
-      result.push_back(*meta);
-    }
+    auto tx_iter = txs_.emplace(iter.key(), std::move(*meta)).first;
+    AddToIndexes(tx_iter->first, tx_iter->second);
   }
-  return result;
+}
+
+void EthTxStateManager::AddToIndexes(const std::string& id,
+                                     const TxMeta& meta) {
+  ids_by_status_[meta.status].insert(id);
+  ids_by_status_and_from_[{meta.status, meta.from.ToHex()}].insert(id);
+}
+
+void EthTxStateManager::RemoveFromIndexes(const std::string& id,
+                                          const TxMeta& meta) {
+  auto status_iter = ids_by_status_.find(meta.status);
+  if (status_iter != ids_by_status_.end()) {
+    status_iter->second.erase(id);
+    if (status_iter->second.empty())
+      ids_by_status_.erase(status_iter);
+  }
+
+  auto from_iter =
+      ids_by_status_and_from_.find({meta.status, meta.from.ToHex()});
+  if (from_iter != ids_by_status_and_from_.end()) {
+    from_iter->second.erase(id);
+    if (from_iter->second.empty())
+      ids_by_status_and_from_.erase(from_iter);
+  }
+}
+
+void EthTxStateManager::OnTransactionsPrefChanged() {
+  if (updating_pref_)
+    return;
+
+  // Reloaded on next use.
+  txs_.clear();
+  ids_by_status_.clear();
+  ids_by_status_and_from_.clear();
+  loaded_ = false;
 }
 
 }  // namespace brave_wallet
@@ -6,13 +6,17 @@
 #ifndef BRAVE_COMPONENTS_BRAVE_WALLET_BROWSER_ETH_TX_STATE_MANAGER_H_
 #define BRAVE_COMPONENTS_BRAVE_WALLET_BROWSER_ETH_TX_STATE_MANAGER_H_
 
+#include <map>
+#include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "base/time/time.h"
 #include "brave/components/brave_wallet/browser/brave_wallet_types.h"
 #include "brave/components/brave_wallet/browser/eth_address.h"
 #include "brave/components/brave_wallet/browser/eth_transaction.h"
+#include "components/prefs/pref_change_registrar.h"
 #include "third_party/abseil-cpp/absl/types/optional.h"
 
 class PrefService;
@@ -23,6 +27,10 @@ class Value;
 
 namespace brave_wallet {
 
+// Persists transactions in prefs and keeps them deserialized in memory, with
+// indexes by status and by status and from address. The pref is only read on
+// first use and when it is changed by someone else, updates change a single
+// entry of it.
 class EthTxStateManager {
  public:
   enum class TransactionStatus {
@@ -73,7 +81,24 @@ class EthTxStateManager {
                                               absl::optional<EthAddress> from);
 
  private:
+  // Loads the transactions from prefs unless they are loaded already.
+  void EnsureLoaded();
+  void AddToIndexes(const std::string& id, const TxMeta& meta);
+  void RemoveFromIndexes(const std::string& id, const TxMeta& meta);
+  void OnTransactionsPrefChanged();
+
   PrefService* prefs_;
+  PrefChangeRegistrar pref_change_registrar_;
+  // Set while the pref is updated from here, so that the loaded transactions
+  // are only dropped on changes made by someone else.
+  bool updating_pref_ = false;
+  bool loaded_ = false;
+
+  // Transactions by pref key, which is their id.
+  std::map<std::string, TxMeta> txs_;
+  std::map<TransactionStatus, std::set<std::string>> ids_by_status_;
+  std::map<std::pair<TransactionStatus, std::string>, std::set<std::string>>
+      ids_by_status_and_from_;
 };
 
 }  // namespace brave_wallet
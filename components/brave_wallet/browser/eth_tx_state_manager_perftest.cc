@@ -0,0 +1,154 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_wallet/browser/eth_tx_state_manager.h"
+
+#include <string>
+#include <vector>
+
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
+#include "base/timer/lap_timer.h"
+#include "base/values.h"
+#include "brave/components/brave_wallet/browser/pref_names.h"
+#include "components/prefs/pref_registry_simple.h"
+#include "components/prefs/testing_pref_service.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+// npm run test -- brave_perftests --filter=EthTxStateManagerPerfTest*
+
+namespace brave_wallet {
+
+namespace {
+
+constexpr int kWarmupRuns = 1;
+constexpr base::TimeDelta kTimeLimit = base::TimeDelta::FromSeconds(2);
+constexpr int kTimeCheckInterval = 1;
+
+// The history of a heavy user: mostly confirmed transactions from a few
+// accounts and a handful still pending
+constexpr size_t kTransactionCount = 10000;
+constexpr size_t kPendingCount = 10;
+constexpr size_t kAccountCount = 5;
+
+constexpr char kMetricTimePerCall[] = ".time_per_call";
+
+using TransactionStatus = EthTxStateManager::TransactionStatus;
+
+EthAddress GetAccountAddress(size_t index) {
+  return EthAddress::FromHex(base::StringPrintf("0x%040zx", index + 1));
+}
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story) {
+  perf_test::PerfResultReporter reporter("EthTxStateManager.", story);
+  reporter.RegisterImportantMetric(kMetricTimePerCall, "us");
+  return reporter;
+}
+
+}  // namespace
+
+class EthTxStateManagerPerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    prefs_.registry()->RegisterDictionaryPref(kBraveWalletTransactions);
+
+    EthTxStateManager tx_state_manager(&prefs_);
+    for (size_t i = 0; i < kTransactionCount; i++) {
+      EthTxStateManager::TxMeta meta;
+      meta.id = base::NumberToString(i);
+      meta.from = GetAccountAddress(i % kAccountCount);
+      meta.status = i < kTransactionCount - kPendingCount
+                        ? TransactionStatus::CONFIRMED
+                        : TransactionStatus::SUBMITTED;
+      meta.tx_hash = base::StringPrintf("0x%064zx", i);
+      tx_state_manager.AddOrUpdateTx(meta);
+    }
+  }
+
+  void Report(const std::string& story, const base::LapTimer& timer) {
+    perf_test::PerfResultReporter reporter = SetUpReporter(story);
+    reporter.AddResult(kMetricTimePerCall,
+                       timer.TimePerLap().InMicrosecondsF());
+  }
+
+  TestingPrefServiceSimple prefs_;
+};
+
+// The pending transactions polled by the pending tracker, found by
+// deserializing every persisted transaction as before the indexes
+TEST_F(EthTxStateManagerPerfTest, PendingByScan) {
+  base::LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    std::vector<EthTxStateManager::TxMeta> result;
+    const base::DictionaryValue* dict =
+        prefs_.GetDictionary(kBraveWalletTransactions);
+    for (base::DictionaryValue::Iterator iter(*dict); !iter.IsAtEnd();
+         iter.Advance()) {
+      auto meta = EthTxStateManager::ValueToTxMeta(iter.value());
+      if (meta && meta->status == TransactionStatus::SUBMITTED)
+        result.push_back(*meta);
+    }
+    EXPECT_EQ(result.size(), kPendingCount);
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+
+  Report("pending_by_scan", timer);
+}
+
+TEST_F(EthTxStateManagerPerfTest, PendingByIndex) {
+  EthTxStateManager tx_state_manager(&prefs_);
+
+  base::LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    EXPECT_EQ(tx_state_manager
+                  .GetTransactionsByStatus(TransactionStatus::SUBMITTED,
+                                           absl::nullopt)
+                  .size(),
+              kPendingCount);
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+
+  Report("pending_by_index", timer);
+}
+
+// The pending transactions of one account, as queried by the nonce tracker
+TEST_F(EthTxStateManagerPerfTest, PendingFromAccountByIndex) {
+  EthTxStateManager tx_state_manager(&prefs_);
+  const EthAddress from = GetAccountAddress(0);
+
+  base::LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    EXPECT_EQ(tx_state_manager
+                  .GetTransactionsByStatus(TransactionStatus::SUBMITTED, from)
+                  .size(),
+              kPendingCount / kAccountCount);
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+
+  Report("pending_from_account_by_index", timer);
+}
+
+// A pending transaction confirmed and back, updating the indexes and its
+// persisted entry
+TEST_F(EthTxStateManagerPerfTest, UpdateStatus) {
+  EthTxStateManager tx_state_manager(&prefs_);
+  EthTxStateManager::TxMeta meta;
+  ASSERT_TRUE(tx_state_manager.GetTx(
+      base::NumberToString(kTransactionCount - 1), &meta));
+
+  base::LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    meta.status = meta.status == TransactionStatus::SUBMITTED
+                      ? TransactionStatus::CONFIRMED
+                      : TransactionStatus::SUBMITTED;
+    tx_state_manager.AddOrUpdateTx(meta);
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+
+  Report("update_status", timer);
+}
+
+}  // namespace brave_wallet
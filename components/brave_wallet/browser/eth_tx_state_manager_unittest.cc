@@ -236,4 +236,55 @@ TEST_F(EthTxStateManagerUnitTest, GetTransactionsByStatus) {
   }
 }
 
+TEST_F(EthTxStateManagerUnitTest, IndexesFollowUpdates) {
+  GetPrefs()->ClearPref(kBraveWalletTransactions);
+  EthTxStateManager tx_state_manager(GetPrefs());
+
+  auto addr1 =
+      EthAddress::FromHex("0x3535353535353535353535353535353535353535");
+  EthTxStateManager::TxMeta meta;
+  meta.id = "001";
+  meta.from = addr1;
+  meta.status = EthTxStateManager::TransactionStatus::SUBMITTED;
+  tx_state_manager.AddOrUpdateTx(meta);
+  EXPECT_EQ(tx_state_manager
+                .GetTransactionsByStatus(
+                    EthTxStateManager::TransactionStatus::SUBMITTED, addr1)
+                .size(),
+            1u);
+
+  // A status change moves the transaction to the other status.
+  meta.status = EthTxStateManager::TransactionStatus::CONFIRMED;
+  tx_state_manager.AddOrUpdateTx(meta);
+  EXPECT_TRUE(tx_state_manager
+                  .GetTransactionsByStatus(
+                      EthTxStateManager::TransactionStatus::SUBMITTED, addr1)
+                  .empty());
+  auto confirmed = tx_state_manager.GetTransactionsByStatus(
+      EthTxStateManager::TransactionStatus::CONFIRMED, addr1);
+  ASSERT_EQ(confirmed.size(), 1u);
+  EXPECT_EQ(confirmed[0], meta);
+
+  tx_state_manager.DeleteTx("001");
+  EXPECT_TRUE(tx_state_manager
+                  .GetTransactionsByStatus(
+                      EthTxStateManager::TransactionStatus::CONFIRMED,
+                      base::nullopt)
+                  .empty());
+
+  // Transactions persisted by another instance are loaded.
+  {
+    EthTxStateManager other_tx_state_manager(GetPrefs());
+    meta.id = "002";
+    other_tx_state_manager.AddOrUpdateTx(meta);
+  }
+  EthTxStateManager::TxMeta meta_fetched;
+  ASSERT_TRUE(tx_state_manager.GetTx("002", &meta_fetched));
+  EXPECT_EQ(meta_fetched, meta);
+
+  // And changes made directly to the pref are picked up.
+  GetPrefs()->ClearPref(kBraveWalletTransactions);
+  EXPECT_FALSE(tx_state_manager.GetTx("002", &meta_fetched));
+}
+
 }  // namespace brave_wallet
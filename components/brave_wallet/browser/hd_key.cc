@@ -5,8 +5,11 @@
 
 #include "brave/components/brave_wallet/browser/hd_key.h"
 
+#include <array>
+
 #include "base/check.h"
 #include "base/logging.h"
+#include "base/rand_util.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_split.h"
 #include "brave/components/brave_wallet/browser/brave_wallet_utils.h"
@@ -24,6 +27,22 @@ constexpr char kMasterSecret[] = "Bitcoin seed";
 #define HARDENED_OFFSET 0x80000000
 #define MAINNET_PUBLIC 0x0488B21E
 #define MAINNET_PRIVATE 0x0488ADE4
+
+// Creating a context precomputes tables, which is much more expensive than
+// deriving a key, so all keys share a single context. It is randomized once
+// for side-channel protection and only read after that, which makes it safe
+// to use from any thread.
+const secp256k1_context* GetSecp256k1Context() {
+  static const secp256k1_context* const context = [] {
+    secp256k1_context* new_context = secp256k1_context_create(
+        SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY);
+    std::array<uint8_t, 32> seed;
+    base::RandBytes(seed.data(), seed.size());
+    CHECK(secp256k1_context_randomize(new_context, seed.data()));
+    return new_context;
+  }();
+  return context;
+}
 }  // namespace
 
 HDKey::HDKey()
@@ -35,8 +54,7 @@ HDKey::HDKey()
       private_key_(0),
       public_key_(33),
       chain_code_(32),
-      secp256k1_ctx_(secp256k1_context_create(SECP256K1_CONTEXT_SIGN |
-                                              SECP256K1_CONTEXT_VERIFY)) {}
+      secp256k1_ctx_(GetSecp256k1Context()) {}
 HDKey::HDKey(uint8_t depth, uint32_t parent_fingerprint, uint32_t index)
     : depth_(depth),
       fingerprint_(0),
@@ -46,11 +64,9 @@ HDKey::HDKey(uint8_t depth, uint32_t parent_fingerprint, uint32_t index)
       private_key_(0),
       public_key_(33),
       chain_code_(32),
-      secp256k1_ctx_(secp256k1_context_create(SECP256K1_CONTEXT_SIGN |
-                                              SECP256K1_CONTEXT_VERIFY)) {}
+      secp256k1_ctx_(GetSecp256k1Context()) {}
 
 HDKey::~HDKey() {
-  secp256k1_context_destroy(secp256k1_ctx_);
   SecureZeroData(private_key_.data(), private_key_.size());
 }
 
@@ -94,7 +94,8 @@ class HDKey {
   std::vector<uint8_t> public_key_;
   std::vector<uint8_t> chain_code_;
 
-  secp256k1_context* secp256k1_ctx_;
+  // Shared by all keys, not owned.
+  const secp256k1_context* const secp256k1_ctx_;
 
   HDKey(const HDKey&) = delete;
   HDKey& operator=(const HDKey&) = delete;
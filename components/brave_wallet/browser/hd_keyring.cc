@@ -5,6 +5,7 @@
 
 #include "brave/components/brave_wallet/browser/hd_keyring.h"
 
+#include "base/check_op.h"
 #include "base/strings/string_number_conversions.h"
 #include "brave/components/brave_wallet/browser/brave_wallet_utils.h"
 #include "brave/components/brave_wallet/browser/eth_address.h"
@@ -27,6 +28,7 @@ void HDKeyring::ClearData() {
   root_.reset();
   master_key_.reset();
   accounts_.clear();
+  addresses_.clear();
 }
 
 void HDKeyring::ConstructRootHDKey(const std::vector<uint8_t>& seed,
@@ -51,15 +53,16 @@ void HDKeyring::AddAccounts(size_t number) {
 std::vector<std::string> HDKeyring::GetAccounts() {
   std::vector<std::string> addresses;
   for (size_t i = 0; i < accounts_.size(); ++i) {
-    addresses.push_back(GetAddress(i));
+    addresses.push_back(GetCachedAddress(i));
   }
   return addresses;
 }
 
 void HDKeyring::RemoveAccount(const std::string& address) {
   for (size_t i = 0; i < accounts_.size(); ++i) {
-    if (GetAddress(i) == address) {
+    if (GetCachedAddress(i) == address) {
       accounts_.erase(accounts_.begin() + i);
+      addresses_.erase(addresses_.begin() + i);
     }
   }
 }
@@ -110,10 +113,19 @@ std::vector<uint8_t> HDKeyring::SignMessage(
 
 HDKey* HDKeyring::GetHDKeyFromAddress(const std::string& address) {
   for (size_t i = 0; i < accounts_.size(); ++i) {
-    if (GetAddress(i) == address)
+    if (GetCachedAddress(i) == address)
       return accounts_[i].get();
   }
   return nullptr;
 }
 
+const std::string& HDKeyring::GetCachedAddress(size_t index) {
+  DCHECK_LT(index, accounts_.size());
+  if (addresses_.size() < accounts_.size())
+    addresses_.resize(accounts_.size());
+  if (addresses_[index].empty())
+    addresses_[index] = GetAddress(index);
+  return addresses_[index];
+}
+
 }  // namespace brave_wallet
@@ -56,6 +56,13 @@ class HDKeyring {
   std::vector<std::unique_ptr<HDKey>> accounts_;
 
  private:
+  // Returns |GetAddress(index)|, computed once per account since it needs a
+  // public key decompression and a hash.
+  const std::string& GetCachedAddress(size_t index);
+
+  // Addresses of |accounts_| by index, empty if not computed yet.
+  std::vector<std::string> addresses_;
+
   FRIEND_TEST_ALL_PREFIXES(HDKeyringUnitTest, ConstructRootHDKey);
   FRIEND_TEST_ALL_PREFIXES(HDKeyringUnitTest, SignMessage);
 
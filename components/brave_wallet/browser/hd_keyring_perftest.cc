@@ -0,0 +1,126 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_wallet/browser/hd_keyring.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/strings/string_number_conversions.h"
+#include "base/timer/lap_timer.h"
+#include "brave/third_party/bitcoin-core/src/src/secp256k1/include/secp256k1.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+// npm run test -- brave_perftests --filter=HDKeyringPerfTest*
+
+namespace brave_wallet {
+
+namespace {
+
+constexpr int kWarmupRuns = 1;
+constexpr base::TimeDelta kTimeLimit = base::TimeDelta::FromSeconds(2);
+constexpr int kTimeCheckInterval = 1;
+
+constexpr size_t kAddressCount = 1000;
+
+constexpr char kMetricTimePerAddress[] = ".time_per_address";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story) {
+  perf_test::PerfResultReporter reporter("HDKeyring.", story);
+  reporter.RegisterImportantMetric(kMetricTimePerAddress, "us");
+  return reporter;
+}
+
+}  // namespace
+
+class HDKeyringPerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(base::HexStringToBytes(
+        "13ca6c28d26812f82db27908de0b0b7b18940cc4e9d96ebd7de190f706741489907e"
+        "f65b8f9e36c31dc46e81472b6a5e40a4487e725ace445b8203f243fb8958",
+        &seed_));
+  }
+
+  std::unique_ptr<HDKeyring> CreateKeyring() {
+    auto keyring = std::make_unique<HDKeyring>();
+    keyring->ConstructRootHDKey(seed_, "m/44'/60'/0'/0");
+    return keyring;
+  }
+
+  void Report(const std::string& story, const base::LapTimer& timer) {
+    perf_test::PerfResultReporter reporter = SetUpReporter(story);
+    reporter.AddResult(kMetricTimePerAddress,
+                       timer.TimePerLap().InMicrosecondsF() / kAddressCount);
+  }
+
+  std::vector<uint8_t> seed_;
+};
+
+// Deriving the addresses with the context setup every key used to do before
+// keys shared a context
+TEST_F(HDKeyringPerfTest, DeriveWithContextPerKey) {
+  base::LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    auto keyring = CreateKeyring();
+    for (size_t i = 0; i < kAddressCount; i++) {
+      secp256k1_context_destroy(secp256k1_context_create(
+          SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY));
+      keyring->AddAccounts();
+    }
+    EXPECT_EQ(keyring->GetAccounts().size(), kAddressCount);
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+
+  Report("derive_context_per_key", timer);
+}
+
+TEST_F(HDKeyringPerfTest, DeriveWithSharedContext) {
+  base::LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    auto keyring = CreateKeyring();
+    keyring->AddAccounts(kAddressCount);
+    EXPECT_EQ(keyring->GetAccounts().size(), kAddressCount);
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+
+  Report("derive_shared_context", timer);
+}
+
+// Listing the addresses of an unlocked keyring, as done for every accounts
+// request, computing each address as before the cache
+TEST_F(HDKeyringPerfTest, ListUncached) {
+  auto keyring = CreateKeyring();
+  keyring->AddAccounts(kAddressCount);
+
+  base::LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    std::vector<std::string> addresses;
+    for (size_t i = 0; i < kAddressCount; i++) {
+      addresses.push_back(keyring->GetAddress(i));
+    }
+    EXPECT_EQ(addresses.size(), kAddressCount);
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+
+  Report("list_uncached", timer);
+}
+
+TEST_F(HDKeyringPerfTest, ListCached) {
+  auto keyring = CreateKeyring();
+  keyring->AddAccounts(kAddressCount);
+
+  base::LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    EXPECT_EQ(keyring->GetAccounts().size(), kAddressCount);
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+
+  Report("list_cached", timer);
+}
+
+}  // namespace brave_wallet
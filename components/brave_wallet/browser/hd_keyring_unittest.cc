@@ -137,4 +137,34 @@ TEST(HDKeyringUnitTest, ClearData) {
   EXPECT_TRUE(keyring.empty());
 }
 
+TEST(HDKeyringUnitTest, CachedAddresses) {
+  HDKeyring keyring;
+  std::vector<uint8_t> seed;
+  EXPECT_TRUE(base::HexStringToBytes(
+      "13ca6c28d26812f82db27908de0b0b7b18940cc4e9d96ebd7de190f706741489907ef65b"
+      "8f9e36c31dc46e81472b6a5e40a4487e725ace445b8203f243fb8958",
+      &seed));
+  keyring.ConstructRootHDKey(seed, "m/44'/60'/0'/0");
+  keyring.AddAccounts(3);
+  EXPECT_EQ(keyring.GetAccounts().size(), 3u);
+
+  // Removing an account keeps the cached addresses in order.
+  keyring.RemoveAccount("0x2A22ad45446E8b34Da4da1f4ADd7B1571Ab4e4E7");
+  keyring.AddAccounts();
+  std::vector<std::string> accounts = keyring.GetAccounts();
+  ASSERT_EQ(accounts.size(), 3u);
+  for (size_t i = 0; i < accounts.size(); ++i)
+    EXPECT_EQ(accounts[i], keyring.GetAddress(i));
+
+  // Cleared addresses are not used for a different seed.
+  keyring.ClearData();
+  seed[0]++;
+  keyring.ConstructRootHDKey(seed, "m/44'/60'/0'/0");
+  keyring.AddAccounts();
+  accounts = keyring.GetAccounts();
+  ASSERT_EQ(accounts.size(), 1u);
+  EXPECT_EQ(accounts[0], keyring.GetAddress(0));
+  EXPECT_NE(accounts[0], "0x2166fB4e11D44100112B1124ac593081519cA1ec");
+}
+
 }  // namespace brave_wallet
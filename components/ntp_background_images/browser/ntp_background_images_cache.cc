@@ -0,0 +1,128 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/ntp_background_images/browser/ntp_background_images_cache.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/callback_helpers.h"
+#include "base/files/file_util.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/task/post_task.h"
+#include "base/task/thread_pool.h"
+
+namespace ntp_background_images {
+
+namespace {
+
+class RefCountedMemoryMappedFile : public base::RefCountedMemory {
+ public:
+  explicit RefCountedMemoryMappedFile(
+      std::unique_ptr<base::MemoryMappedFile> file)
+      : file_(std::move(file)) {}
+
+  RefCountedMemoryMappedFile(const RefCountedMemoryMappedFile&) = delete;
+  RefCountedMemoryMappedFile& operator=(const RefCountedMemoryMappedFile&) =
+      delete;
+
+  // base::RefCountedMemory:
+  const unsigned char* front() const override { return file_->data(); }
+  size_t size() const override { return file_->length(); }
+
+ private:
+  ~RefCountedMemoryMappedFile() override {
+    // The last reference is usually released on the UI thread, where the file
+    // can't be closed.
+    base::ThreadPool::PostTask(
+        FROM_HERE, {base::MayBlock(), base::TaskPriority::BEST_EFFORT},
+        base::BindOnce(
+            base::DoNothing::Once<std::unique_ptr<base::MemoryMappedFile>>(),
+            std::move(file_)));
+  }
+
+  std::unique_ptr<base::MemoryMappedFile> file_;
+};
+
+scoped_refptr<base::RefCountedMemory> LoadImage(const base::FilePath& path) {
+  auto file = std::make_unique<base::MemoryMappedFile>();
+  if (file->Initialize(path) && file->length() > 0)
+    return base::MakeRefCounted<RefCountedMemoryMappedFile>(std::move(file));
+
+  // Empty files can't be mapped.
+  std::string contents;
+  if (!base::ReadFileToString(path, &contents))
+    return nullptr;
+  return base::RefCountedString::TakeString(&contents);
+}
+
+}  // namespace
+
+NTPBackgroundImagesCache::NTPBackgroundImagesCache(size_t max_size)
+    : max_size_(max_size),
+      images_(decltype(images_)::NO_AUTO_EVICT) {}
+
+NTPBackgroundImagesCache::~NTPBackgroundImagesCache() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+}
+
+void NTPBackgroundImagesCache::GetImage(const base::FilePath& path,
+                                        GetImageCallback callback) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  auto iter = images_.Get(path);
+  if (iter != images_.end()) {
+    std::move(callback).Run(iter->second);
+    return;
+  }
+
+  auto& callbacks = pending_requests_[path];
+  callbacks.push_back(std::move(callback));
+  if (callbacks.size() > 1)
+    return;
+
+  base::ThreadPool::PostTaskAndReplyWithResult(
+      FROM_HERE, {base::MayBlock(), base::TaskPriority::USER_VISIBLE},
+      base::BindOnce(&LoadImage, path),
+      base::BindOnce(&NTPBackgroundImagesCache::OnImageLoaded,
+                     weak_factory_.GetWeakPtr(), path, generation_));
+}
+
+void NTPBackgroundImagesCache::Clear() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  images_.Clear();
+  size_ = 0;
+  generation_++;
+}
+
+void NTPBackgroundImagesCache::OnImageLoaded(
+    const base::FilePath& path,
+    int generation,
+    scoped_refptr<base::RefCountedMemory> image) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  if (image && generation == generation_ && image->size() <= max_size_ &&
+      images_.Peek(path) == images_.end()) {
+    images_.Put(path, image);
+    size_ += image->size();
+    while (size_ > max_size_) {
+      auto oldest = images_.rbegin();
+      size_ -= oldest->second->size();
+      images_.Erase(oldest);
+    }
+  }
+
+  auto iter = pending_requests_.find(path);
+  DCHECK(iter != pending_requests_.end());
+  std::vector<GetImageCallback> callbacks = std::move(iter->second);
+  pending_requests_.erase(iter);
+
+  for (auto& callback : callbacks)
+    std::move(callback).Run(image);
+}
+
+}  // namespace ntp_background_images
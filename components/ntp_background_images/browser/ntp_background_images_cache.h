@@ -0,0 +1,70 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_NTP_BACKGROUND_IMAGES_BROWSER_NTP_BACKGROUND_IMAGES_CACHE_H_
+#define BRAVE_COMPONENTS_NTP_BACKGROUND_IMAGES_BROWSER_NTP_BACKGROUND_IMAGES_CACHE_H_
+
+#include <map>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/containers/mru_cache.h"
+#include "base/files/file_path.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/memory/weak_ptr.h"
+#include "base/sequence_checker.h"
+
+namespace ntp_background_images {
+
+// Keeps the images of the current background images rotation in memory, so
+// that opening a new tab does not read them from disk again. Images are
+// memory-mapped when possible, so they are not copied either.
+// Component updates install into a new versioned directory, so cached paths
+// always refer to the installed version. The cache is cleared when new
+// component data is loaded.
+class NTPBackgroundImagesCache {
+ public:
+  using GetImageCallback =
+      base::OnceCallback<void(scoped_refptr<base::RefCountedMemory>)>;
+
+  // |max_size| bounds the total size of the cached images in bytes.
+  explicit NTPBackgroundImagesCache(size_t max_size);
+  ~NTPBackgroundImagesCache();
+
+  NTPBackgroundImagesCache(const NTPBackgroundImagesCache&) = delete;
+  NTPBackgroundImagesCache& operator=(const NTPBackgroundImagesCache&) =
+      delete;
+
+  // Runs |callback| with the contents of |path|, or with null if it can't be
+  // read. Reads the file in the background if it is not cached, concurrent
+  // requests for the same file share the read.
+  void GetImage(const base::FilePath& path, GetImageCallback callback);
+
+  void Clear();
+
+  size_t size() const { return size_; }
+
+ private:
+  void OnImageLoaded(const base::FilePath& path,
+                     int generation,
+                     scoped_refptr<base::RefCountedMemory> image);
+
+  const size_t max_size_;
+  size_t size_ = 0;
+  // Incremented by |Clear()|, so that images loaded before are not cached.
+  int generation_ = 0;
+
+  base::MRUCache<base::FilePath, scoped_refptr<base::RefCountedMemory>>
+      images_;
+  std::map<base::FilePath, std::vector<GetImageCallback>> pending_requests_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+
+  base::WeakPtrFactory<NTPBackgroundImagesCache> weak_factory_{this};
+};
+
+}  // namespace ntp_background_images
+
+#endif  // BRAVE_COMPONENTS_NTP_BACKGROUND_IMAGES_BROWSER_NTP_BACKGROUND_IMAGES_CACHE_H_
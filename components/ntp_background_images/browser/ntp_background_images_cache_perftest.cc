@@ -0,0 +1,143 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/ntp_background_images/browser/ntp_background_images_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/strings/stringprintf.h"
+#include "base/task/post_task.h"
+#include "base/task/thread_pool.h"
+#include "base/test/task_environment.h"
+#include "base/timer/lap_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+
+// npm run test -- brave_perftests --filter=NTPBackgroundImagesCachePerfTest*
+
+namespace ntp_background_images {
+
+namespace {
+
+constexpr int kWarmupRuns = 1;
+constexpr base::TimeDelta kTimeLimit = base::TimeDelta::FromSeconds(2);
+constexpr int kTimeCheckInterval = 1;
+
+// A sponsored images rotation: a few multi-MB wallpapers and their logos
+constexpr int kWallpaperCount = 3;
+constexpr size_t kWallpaperSize = 3 * 1024 * 1024;
+constexpr size_t kLogoSize = 32 * 1024;
+
+constexpr char kMetricTimePerOpen[] = ".time_per_ntp_open";
+
+absl::optional<std::string> ReadFileToString(const base::FilePath& path) {
+  std::string contents;
+  if (!base::ReadFileToString(path, &contents))
+    return absl::optional<std::string>();
+  return contents;
+}
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story) {
+  perf_test::PerfResultReporter reporter("NTPBackgroundImagesCache.", story);
+  reporter.RegisterImportantMetric(kMetricTimePerOpen, "us");
+  return reporter;
+}
+
+}  // namespace
+
+class NTPBackgroundImagesCachePerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    for (int i = 0; i < kWallpaperCount; i++) {
+      wallpapers_.push_back(WriteImage(
+          base::StringPrintf("wallpaper-%d.jpg", i), kWallpaperSize));
+      logos_.push_back(
+          WriteImage(base::StringPrintf("logo-%d.png", i), kLogoSize));
+    }
+  }
+
+  base::FilePath WriteImage(const std::string& name, size_t size) {
+    const base::FilePath path = temp_dir_.GetPath().AppendASCII(name);
+    EXPECT_TRUE(base::WriteFile(path, std::string(size, 'x')));
+    return path;
+  }
+
+  // Opening a new tab requests the wallpaper and the logo of the next
+  // background in the rotation. Returns the time per opened tab.
+  template <typename GetImageFunction>
+  base::TimeDelta MeasureNTPOpens(GetImageFunction get_image) {
+    size_t bytes_served = 0;
+    int index = 0;
+
+    base::LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+    do {
+      auto on_image = base::BindRepeating(
+          [](size_t* bytes_served,
+             scoped_refptr<base::RefCountedMemory> image) {
+            *bytes_served += image->size();
+          },
+          &bytes_served);
+      get_image(wallpapers_[index], on_image);
+      get_image(logos_[index], on_image);
+      task_environment_.RunUntilIdle();
+      index = (index + 1) % kWallpaperCount;
+      timer.NextLap();
+    } while (!timer.HasTimeLimitExpired());
+
+    EXPECT_GT(bytes_served, 0u);
+    return timer.TimePerLap();
+  }
+
+  void Report(const std::string& story, base::TimeDelta time_per_open) {
+    perf_test::PerfResultReporter reporter = SetUpReporter(story);
+    reporter.AddResult(kMetricTimePerOpen, time_per_open.InMicrosecondsF());
+  }
+
+  base::test::TaskEnvironment task_environment_;
+  base::ScopedTempDir temp_dir_;
+  std::vector<base::FilePath> wallpapers_;
+  std::vector<base::FilePath> logos_;
+};
+
+// Every image read from disk and copied, as the source did before the cache
+TEST_F(NTPBackgroundImagesCachePerfTest, ReadAndCopy) {
+  using Callback =
+      base::RepeatingCallback<void(scoped_refptr<base::RefCountedMemory>)>;
+  const base::TimeDelta time_per_open =
+      MeasureNTPOpens([](const base::FilePath& path, Callback callback) {
+        base::ThreadPool::PostTaskAndReplyWithResult(
+            FROM_HERE, {base::MayBlock()},
+            base::BindOnce(&ReadFileToString, path),
+            base::BindOnce(
+                [](Callback callback, absl::optional<std::string> input) {
+                  ASSERT_TRUE(input);
+                  callback.Run(new base::RefCountedBytes(
+                      reinterpret_cast<const unsigned char*>(input->c_str()),
+                      input->length()));
+                },
+                callback));
+      });
+  Report("read_and_copy", time_per_open);
+}
+
+// Images of the rotation served from the cache after the first open
+TEST_F(NTPBackgroundImagesCachePerfTest, Cached) {
+  NTPBackgroundImagesCache cache(32 * 1024 * 1024);
+  const base::TimeDelta time_per_open = MeasureNTPOpens(
+      [&cache](const base::FilePath& path,
+               base::RepeatingCallback<void(
+                   scoped_refptr<base::RefCountedMemory>)> callback) {
+        cache.GetImage(path, callback);
+      });
+  Report("cached", time_per_open);
+}
+
+}  // namespace ntp_background_images
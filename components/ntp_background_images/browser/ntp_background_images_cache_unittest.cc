@@ -0,0 +1,135 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/ntp_background_images/browser/ntp_background_images_cache.h"
+
+#include <string>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/test/task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+// npm run test -- brave_unit_tests --filter=NTPBackgroundImagesCacheTest.*
+
+namespace ntp_background_images {
+
+namespace {
+
+std::string ToString(const scoped_refptr<base::RefCountedMemory>& image) {
+  return std::string(image->front_as<char>(), image->size());
+}
+
+}  // namespace
+
+class NTPBackgroundImagesCacheTest : public testing::Test {
+ protected:
+  void SetUp() override { ASSERT_TRUE(temp_dir_.CreateUniqueTempDir()); }
+
+  base::FilePath WriteImage(const std::string& name,
+                            const std::string& contents) {
+    const base::FilePath path = temp_dir_.GetPath().AppendASCII(name);
+    EXPECT_TRUE(base::WriteFile(path, contents));
+    return path;
+  }
+
+  scoped_refptr<base::RefCountedMemory> GetImage(
+      NTPBackgroundImagesCache* cache,
+      const base::FilePath& path) {
+    scoped_refptr<base::RefCountedMemory> result;
+    cache->GetImage(path,
+                    base::BindOnce(
+                        [](scoped_refptr<base::RefCountedMemory>* result,
+                           scoped_refptr<base::RefCountedMemory> image) {
+                          *result = std::move(image);
+                        },
+                        &result));
+    task_environment_.RunUntilIdle();
+    return result;
+  }
+
+  base::test::TaskEnvironment task_environment_;
+  base::ScopedTempDir temp_dir_;
+};
+
+TEST_F(NTPBackgroundImagesCacheTest, ServesCachedImages) {
+  NTPBackgroundImagesCache cache(1024);
+  const base::FilePath path = WriteImage("wallpaper-0.jpg", "wallpaper");
+
+  auto image = GetImage(&cache, path);
+  ASSERT_TRUE(image);
+  EXPECT_EQ(ToString(image), "wallpaper");
+  EXPECT_EQ(cache.size(), 9u);
+
+  // Served from memory once cached.
+  EXPECT_EQ(GetImage(&cache, path), image);
+
+  cache.Clear();
+  EXPECT_EQ(cache.size(), 0u);
+  auto reloaded_image = GetImage(&cache, path);
+  ASSERT_TRUE(reloaded_image);
+  EXPECT_NE(reloaded_image, image);
+  EXPECT_EQ(ToString(reloaded_image), "wallpaper");
+}
+
+TEST_F(NTPBackgroundImagesCacheTest, SharesConcurrentReads) {
+  NTPBackgroundImagesCache cache(1024);
+  const base::FilePath path = WriteImage("logo.png", "logo");
+
+  int count = 0;
+  for (int i = 0; i < 3; i++) {
+    cache.GetImage(path,
+                   base::BindOnce(
+                       [](int* count, scoped_refptr<base::RefCountedMemory>
+                                          image) {
+                         ASSERT_TRUE(image);
+                         EXPECT_EQ(ToString(image), "logo");
+                         (*count)++;
+                       },
+                       &count));
+  }
+  task_environment_.RunUntilIdle();
+
+  EXPECT_EQ(count, 3);
+  EXPECT_EQ(cache.size(), 4u);
+}
+
+TEST_F(NTPBackgroundImagesCacheTest, EvictsLeastRecentlyUsed) {
+  NTPBackgroundImagesCache cache(10);
+  const base::FilePath first = WriteImage("wallpaper-0.jpg", "12345");
+  const base::FilePath second = WriteImage("wallpaper-1.jpg", "12345");
+  const base::FilePath third = WriteImage("wallpaper-2.jpg", "12345");
+  const base::FilePath large = WriteImage("wallpaper-3.jpg", "12345678901");
+
+  auto first_image = GetImage(&cache, first);
+  auto second_image = GetImage(&cache, second);
+  EXPECT_EQ(GetImage(&cache, first), first_image);
+  GetImage(&cache, third);
+  EXPECT_EQ(cache.size(), 10u);
+
+  EXPECT_EQ(GetImage(&cache, first), first_image);
+  EXPECT_NE(GetImage(&cache, second), second_image);
+
+  // Images larger than the cache are served but not cached.
+  auto large_image = GetImage(&cache, large);
+  ASSERT_TRUE(large_image);
+  EXPECT_EQ(ToString(large_image), "12345678901");
+  EXPECT_NE(GetImage(&cache, large), large_image);
+  EXPECT_EQ(cache.size(), 10u);
+}
+
+TEST_F(NTPBackgroundImagesCacheTest, HandlesEmptyAndMissingFiles) {
+  NTPBackgroundImagesCache cache(1024);
+
+  auto empty_image = GetImage(&cache, WriteImage("empty.png", ""));
+  ASSERT_TRUE(empty_image);
+  EXPECT_EQ(empty_image->size(), 0u);
+
+  EXPECT_FALSE(GetImage(&cache, temp_dir_.GetPath().AppendASCII("none.png")));
+}
+
+}  // namespace ntp_background_images
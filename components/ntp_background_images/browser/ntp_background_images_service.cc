@@ -41,6 +41,8 @@ namespace ntp_background_images {
 namespace {
 
 constexpr int kSIComponentUpdateCheckIntervalHours = 1;
+// Enough for the wallpapers and logos of a rotation.
+constexpr size_t kImageCacheMaxSize = 32 * 1024 * 1024;
 constexpr char kNTPManifestFile[] = "photo.json";
 constexpr char kNTPSRMappingTableFile[] = "mapping-table.json";
 
@@ -101,6 +103,7 @@ NTPBackgroundImagesService::NTPBackgroundImagesService(
     PrefService* local_pref)
     : component_update_service_(cus),
       local_pref_(local_pref),
+      image_cache_(kImageCacheMaxSize),
       weak_factory_(this) {
 }
 
@@ -443,6 +446,9 @@ void NTPBackgroundImagesService::OnComponentReady(
 void NTPBackgroundImagesService::OnGetComponentJsonData(
     bool is_super_referral,
     const std::string& json_string) {
+  // Images of the previous version are no longer served.
+  image_cache_.Clear();
+
   if (is_super_referral) {
     local_pref_->SetBoolean(
           prefs::kNewTabPageGetInitialSRComponentInProgress,
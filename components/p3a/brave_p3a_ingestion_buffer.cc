@@ -0,0 +1,50 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/p3a/brave_p3a_ingestion_buffer.h"
+
+#include "base/check_op.h"
+
+namespace brave {
+
+BraveP3AIngestionBuffer::BraveP3AIngestionBuffer(size_t histogram_count)
+    : histogram_count_(histogram_count),
+      slots_(new std::atomic<uint64_t>[histogram_count]) {
+  for (size_t i = 0; i < histogram_count_; i++) {
+    slots_[i].store(0);
+  }
+}
+
+BraveP3AIngestionBuffer::~BraveP3AIngestionBuffer() = default;
+
+bool BraveP3AIngestionBuffer::Add(size_t histogram_index, size_t bucket) {
+  DCHECK_LT(histogram_index, histogram_count_);
+  slots_[histogram_index].store(static_cast<uint64_t>(bucket) + 1);
+  update_count_++;
+
+  // The slot is written before the flag is checked, so an update is either
+  // seen by a batch that is already pending or schedules a new one.
+  if (batch_pending_.exchange(true)) {
+    return false;
+  }
+
+  batch_count_++;
+  return true;
+}
+
+std::vector<std::pair<size_t, size_t>> BraveP3AIngestionBuffer::TakeUpdates() {
+  batch_pending_.store(false);
+
+  std::vector<std::pair<size_t, size_t>> updates;
+  for (size_t i = 0; i < histogram_count_; i++) {
+    const uint64_t value = slots_[i].exchange(0);
+    if (value != 0) {
+      updates.emplace_back(i, static_cast<size_t>(value - 1));
+    }
+  }
+  return updates;
+}
+
+}  // namespace brave
@@ -0,0 +1,57 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_P3A_BRAVE_P3A_INGESTION_BUFFER_H_
+#define BRAVE_COMPONENTS_P3A_BRAVE_P3A_INGESTION_BUFFER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace brave {
+
+// Collects histogram updates recorded on any thread so that they can be
+// handed off to the UI thread in batches. Keeps only the latest bucket of
+// each histogram, since a newer value replaces an older one in the log store
+// anyway. Lock-free: each histogram has its own atomic slot.
+class BraveP3AIngestionBuffer {
+ public:
+  explicit BraveP3AIngestionBuffer(size_t histogram_count);
+  ~BraveP3AIngestionBuffer();
+
+  BraveP3AIngestionBuffer(const BraveP3AIngestionBuffer&) = delete;
+  BraveP3AIngestionBuffer& operator=(const BraveP3AIngestionBuffer&) = delete;
+
+  // Records |bucket| for the histogram at |histogram_index|. May be called on
+  // any thread. Returns true if the caller has to schedule a call to
+  // |TakeUpdates()|, i.e. if no batch was already pending.
+  bool Add(size_t histogram_index, size_t bucket);
+
+  // Returns the pending (histogram index, bucket) pairs and empties the
+  // buffer.
+  std::vector<std::pair<size_t, size_t>> TakeUpdates();
+
+  // The number of updates added and of batches handed off, i.e. of tasks
+  // posted by callers. Their difference is the number of tasks saved.
+  uint64_t update_count() const { return update_count_; }
+  uint64_t batch_count() const { return batch_count_; }
+
+ private:
+  const size_t histogram_count_;
+  // The pending bucket of each histogram plus one, or zero if there is none.
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+  std::atomic<bool> batch_pending_{false};
+
+  std::atomic<uint64_t> update_count_{0};
+  std::atomic<uint64_t> batch_count_{0};
+};
+
+}  // namespace brave
+
+#endif  // BRAVE_COMPONENTS_P3A_BRAVE_P3A_INGESTION_BUFFER_H_
@@ -0,0 +1,86 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/p3a/brave_p3a_ingestion_buffer.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+// npm run test -- brave_unit_tests --filter=BraveP3AIngestionBufferTest.*
+
+namespace brave {
+
+namespace {
+
+using Updates = std::vector<std::pair<size_t, size_t>>;
+
+constexpr size_t kHistogramCount = 4;
+constexpr int kThreadCount = 4;
+constexpr size_t kUpdatesPerThread = 1000;
+
+class Recorder : public base::DelegateSimpleThread::Delegate {
+ public:
+  explicit Recorder(BraveP3AIngestionBuffer* buffer) : buffer_(buffer) {}
+
+  void Run() override {
+    for (size_t i = 0; i < kUpdatesPerThread; i++) {
+      buffer_->Add(i % kHistogramCount, i);
+    }
+  }
+
+ private:
+  BraveP3AIngestionBuffer* buffer_;
+};
+
+}  // namespace
+
+TEST(BraveP3AIngestionBufferTest, KeepsLatestBucket) {
+  BraveP3AIngestionBuffer buffer(3);
+
+  // Only the first update of a batch asks for it to be scheduled.
+  EXPECT_TRUE(buffer.Add(0, 1));
+  EXPECT_FALSE(buffer.Add(2, 0));
+  EXPECT_FALSE(buffer.Add(0, 5));
+  EXPECT_EQ(buffer.TakeUpdates(), Updates({{0, 5}, {2, 0}}));
+
+  EXPECT_TRUE(buffer.TakeUpdates().empty());
+
+  EXPECT_TRUE(buffer.Add(1, 3));
+  EXPECT_EQ(buffer.TakeUpdates(), Updates({{1, 3}}));
+
+  EXPECT_EQ(buffer.update_count(), 4u);
+  EXPECT_EQ(buffer.batch_count(), 2u);
+}
+
+TEST(BraveP3AIngestionBufferTest, AddFromManyThreads) {
+  BraveP3AIngestionBuffer buffer(kHistogramCount);
+  std::vector<std::unique_ptr<base::DelegateSimpleThread>> threads;
+
+  Recorder recorder(&buffer);
+  for (int i = 0; i < kThreadCount; i++) {
+    threads.push_back(std::make_unique<base::DelegateSimpleThread>(
+        &recorder, "P3AIngestion"));
+    threads.back()->Start();
+  }
+  for (auto& thread : threads) {
+    thread->Join();
+  }
+
+  // Each histogram keeps one of the buckets recorded for it.
+  const Updates updates = buffer.TakeUpdates();
+  ASSERT_EQ(updates.size(), kHistogramCount);
+  for (size_t i = 0; i < kHistogramCount; i++) {
+    EXPECT_EQ(updates[i].first, i);
+    EXPECT_EQ(updates[i].second % kHistogramCount, i);
+  }
+  EXPECT_EQ(buffer.update_count(), kThreadCount * kUpdatesPerThread);
+  EXPECT_EQ(buffer.batch_count(), 1u);
+}
+
+}  // namespace brave
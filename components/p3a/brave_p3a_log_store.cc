@@ -5,11 +5,20 @@
 
 #include "brave/components/p3a/brave_p3a_log_store.h"
 
+#include <algorithm>
+#include <utility>
+
+#include "base/big_endian.h"
+#include "base/bind.h"
+#include "base/files/file_util.h"
 #include "base/logging.h"
 #include "base/metrics/histogram_macros.h"
+#include "base/metrics/metrics_hashes.h"
 #include "base/rand_util.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
+#include "base/task/post_task.h"
+#include "base/task/thread_pool.h"
 #include "components/prefs/pref_registry_simple.h"
 #include "components/prefs/pref_service.h"
 #include "components/prefs/scoped_user_pref_update.h"
@@ -17,11 +26,26 @@
 namespace brave {
 
 namespace {
+// Deprecated, the logs are moved to the file on load.
 constexpr char kPrefName[] = "p3a.logs";
 constexpr char kLogValueKey[] = "value";
 constexpr char kLogSentKey[] = "sent";
 constexpr char kLogTimestampKey[] = "timestamp";
 
+// File layout, all integers are big-endian:
+//   header: magic (4), version (4), record count (4), reserved (4)
+//   record: name hash (8), value (8), sent timestamp (8), flags (1),
+//           reserved (7)
+// Records are sorted by name hash.
+constexpr uint32_t kFileMagic = 0x5033414c;  // "P3AL"
+constexpr uint32_t kFileVersion = 1;
+constexpr size_t kHeaderSize = 16;
+constexpr size_t kRecordSize = 32;
+constexpr uint8_t kRecordSentFlag = 1 << 0;
+// Much more than the number of collected histograms, only guards against
+// reading a corrupted file.
+constexpr uint32_t kMaxRecordCount = 4096;
+
 void RecordP3A(uint64_t answers_count) {
   int answer = 0;
   if (1 <= answers_count && answers_count < 5) {
@@ -36,14 +60,29 @@ void RecordP3A(uint64_t answers_count) {
 
 }  // namespace
 
+struct BraveP3ALogStore::LogRecord {
+  uint64_t name_hash = 0u;
+  LogEntry entry;
+};
+
 BraveP3ALogStore::BraveP3ALogStore(Delegate* delegate,
-                                   PrefService* local_state)
-    : delegate_(delegate), local_state_(local_state) {
+                                   PrefService* local_state,
+                                   const base::FilePath& path)
+    : delegate_(delegate),
+      local_state_(local_state),
+      file_task_runner_(base::ThreadPool::CreateSequencedTaskRunner(
+          {base::MayBlock(), base::TaskPriority::BEST_EFFORT,
+           base::TaskShutdownBehavior::BLOCK_SHUTDOWN})),
+      writer_(path, file_task_runner_) {
   DCHECK(delegate_);
   DCHECK(local_state);
 }
 
-BraveP3ALogStore::~BraveP3ALogStore() = default;
+BraveP3ALogStore::~BraveP3ALogStore() {
+  if (writer_.HasPendingWrite()) {
+    writer_.DoScheduledWrite();
+  }
+}
 
 void BraveP3ALogStore::RegisterPrefs(PrefRegistrySimple* registry) {
   registry->RegisterDictionaryPref(kPrefName);
@@ -57,22 +96,20 @@ void BraveP3ALogStore::UpdateValue(const std::string& histogram_name,
     DCHECK(entry.sent_timestamp.is_null());
     unsent_entries_.insert(histogram_name);
   }
+  removed_while_loading_.erase(histogram_name);
 
-  // Update the persistent value.
-  DictionaryPrefUpdate update(local_state_, kPrefName);
-  update->SetPath({histogram_name, kLogValueKey},
-                  base::Value(base::NumberToString(value)));
-  update->SetPath({histogram_name, kLogSentKey}, base::Value(entry.sent));
+  ScheduleWrite();
 }
 
 void BraveP3ALogStore::RemoveValueIfExists(const std::string& histogram_name) {
   DCHECK(delegate_->IsActualMetric(histogram_name));
   log_.erase(histogram_name);
   unsent_entries_.erase(histogram_name);
+  if (!loaded_) {
+    removed_while_loading_.insert(histogram_name);
+  }
 
-  // Update the persistent value.
-  DictionaryPrefUpdate update(local_state_, kPrefName);
-  update->RemovePath(histogram_name);
+  ScheduleWrite();
 
   if (has_staged_log() && staged_entry_key_ == histogram_name) {
     staged_entry_key_.clear();
@@ -82,20 +119,18 @@ void BraveP3ALogStore::RemoveValueIfExists(const std::string& histogram_name) {
 
 void BraveP3ALogStore::ResetUploadStamps() {
   // Clear log entries flags.
-  DictionaryPrefUpdate update(local_state_, kPrefName);
   for (auto& pair : log_) {
     if (pair.second.sent) {
       DCHECK(!pair.second.sent_timestamp.is_null());
       DCHECK(!unsent_entries_.contains(pair.first));
 
       pair.second.ResetSentState();
-
-      // Update persistent values.
-      update->SetPath({pair.first, kLogSentKey}, base::Value(pair.second.sent));
-      update->SetPath({pair.first, kLogTimestampKey},
-                      base::Value(pair.second.sent_timestamp.ToDoubleT()));
     }
   }
+  if (!loaded_) {
+    reset_upload_stamps_while_loading_ = true;
+  }
+  ScheduleWrite();
 
   RecordP3A(log_.size() - unsent_entries_.size());
 
@@ -166,13 +201,7 @@ void BraveP3ALogStore::DiscardStagedLog() {
   auto log_iter = log_.find(staged_entry_key_);
   DCHECK(log_iter != log_.end());
   log_iter->second.MarkAsSent();
-
-  // Update the persistent value.
-  DictionaryPrefUpdate update(local_state_, kPrefName);
-  update->SetPath({log_iter->first, kLogSentKey},
-                  base::Value(log_iter->second.sent));
-  update->SetPath({log_iter->first, kLogTimestampKey},
-                  base::Value(log_iter->second.sent_timestamp.ToDoubleT()));
+  ScheduleWrite();
 
   // Erase the entry from the unsent queue.
   auto unsent_entries_iter = unsent_entries_.find(staged_entry_key_);
@@ -193,6 +222,147 @@ void BraveP3ALogStore::LoadPersistedUnsentLogs() {
   DCHECK(log_.empty());
   DCHECK(unsent_entries_.empty());
 
+  if (!local_state_->GetDictionary(kPrefName)->DictEmpty()) {
+    LoadFromPrefs();
+    local_state_->ClearPref(kPrefName);
+    loaded_ = true;
+    // Write right away, the logs are no longer in local state.
+    ScheduleWrite();
+    writer_.DoScheduledWrite();
+    return;
+  }
+
+  base::PostTaskAndReplyWithResult(
+      file_task_runner_.get(), FROM_HERE,
+      base::BindOnce(&BraveP3ALogStore::ReadLogRecords, writer_.path()),
+      base::BindOnce(&BraveP3ALogStore::OnLoadedFromFile,
+                     weak_factory_.GetWeakPtr()));
+}
+
+bool BraveP3ALogStore::SerializeData(std::string* data) {
+  std::vector<LogRecord> records;
+  records.reserve(log_.size());
+  for (const auto& pair : log_) {
+    LogRecord record;
+    record.name_hash = base::HashMetricName(pair.first);
+    record.entry = pair.second;
+    records.push_back(record);
+  }
+  std::sort(records.begin(), records.end(),
+            [](const LogRecord& a, const LogRecord& b) {
+              return a.name_hash < b.name_hash;
+            });
+
+  data->assign(kHeaderSize + records.size() * kRecordSize, '\0');
+  base::BigEndianWriter writer(&(*data)[0], data->size());
+  writer.WriteU32(kFileMagic);
+  writer.WriteU32(kFileVersion);
+  writer.WriteU32(static_cast<uint32_t>(records.size()));
+  writer.Skip(4);
+  for (const auto& record : records) {
+    writer.WriteU64(record.name_hash);
+    writer.WriteU64(record.entry.value);
+    writer.WriteU64(static_cast<uint64_t>(
+        record.entry.sent_timestamp.ToDeltaSinceWindowsEpoch()
+            .InMicroseconds()));
+    writer.WriteU8(record.entry.sent ? kRecordSentFlag : 0);
+    writer.Skip(7);
+  }
+  DCHECK_EQ(writer.remaining(), 0u);
+  return true;
+}
+
+// static
+std::vector<BraveP3ALogStore::LogRecord> BraveP3ALogStore::ReadLogRecords(
+    const base::FilePath& path) {
+  std::vector<LogRecord> records;
+  std::string data;
+  if (!base::ReadFileToStringWithMaxSize(
+          path, &data, kHeaderSize + kMaxRecordCount * kRecordSize)) {
+    return records;
+  }
+
+  base::BigEndianReader reader(data.data(), data.size());
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  uint32_t count = 0;
+  if (!reader.ReadU32(&magic) || !reader.ReadU32(&version) ||
+      !reader.ReadU32(&count) || !reader.Skip(4) || magic != kFileMagic ||
+      version != kFileVersion || reader.remaining() != count * kRecordSize) {
+    LOG(ERROR) << "BraveP3ALogStore: malformed log file " << path;
+    return records;
+  }
+
+  records.resize(count);
+  for (auto& record : records) {
+    uint64_t timestamp = 0;
+    uint8_t flags = 0;
+    reader.ReadU64(&record.name_hash);
+    reader.ReadU64(&record.entry.value);
+    reader.ReadU64(&timestamp);
+    reader.ReadU8(&flags);
+    reader.Skip(7);
+
+    record.entry.sent = flags & kRecordSentFlag;
+    record.entry.sent_timestamp = base::Time::FromDeltaSinceWindowsEpoch(
+        base::TimeDelta::FromMicroseconds(static_cast<int64_t>(timestamp)));
+  }
+  return records;
+}
+
+void BraveP3ALogStore::OnLoadedFromFile(std::vector<LogRecord> records) {
+  DCHECK(!loaded_);
+  // Either values were updated while loading or the file lacks obsolete
+  // records, so it has to be rewritten.
+  bool needs_write = !log_.empty() || !removed_while_loading_.empty();
+
+  for (auto& record : records) {
+    const std::string name(delegate_->GetMetricName(record.name_hash));
+    if (name.empty()) {
+      needs_write = true;
+      continue;
+    }
+    if (removed_while_loading_.contains(name)) {
+      continue;
+    }
+    if (reset_upload_stamps_while_loading_) {
+      record.entry.ResetSentState();
+    }
+
+    auto iter = log_.find(name);
+    if (iter == log_.end()) {
+      log_[name] = record.entry;
+      if (!record.entry.sent) {
+        unsent_entries_.insert(name);
+      }
+      continue;
+    }
+
+    // The value was updated while loading, only keep the sent state so that
+    // it is not sent twice in the same period.
+    if (record.entry.sent && !iter->second.sent && staged_entry_key_ != name) {
+      iter->second.sent = true;
+      iter->second.sent_timestamp = record.entry.sent_timestamp;
+      unsent_entries_.erase(name);
+    }
+  }
+
+  loaded_ = true;
+  reset_upload_stamps_while_loading_ = false;
+  removed_while_loading_.clear();
+
+  if (needs_write) {
+    ScheduleWrite();
+  }
+}
+
+void BraveP3ALogStore::ScheduleWrite() {
+  if (loaded_) {
+    writer_.ScheduleWrite(this);
+  }
+}
+
+void BraveP3ALogStore::LoadFromPrefs() {
   DictionaryPrefUpdate update(local_state_, kPrefName);
   base::DictionaryValue* list = update.Get();
   for (auto dict_item : list->DictItems()) {
@@ -7,9 +7,15 @@
 #define BRAVE_COMPONENTS_P3A_BRAVE_P3A_LOG_STORE_H_
 
 #include <string>
+#include <vector>
 
 #include "base/containers/flat_map.h"
 #include "base/containers/flat_set.h"
+#include "base/files/file_path.h"
+#include "base/files/important_file_writer.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/sequenced_task_runner.h"
 #include "base/strings/string_piece.h"
 #include "base/time/time.h"
 #include "components/metrics/log_store.h"
@@ -19,11 +25,16 @@ class PrefRegistrySimple;
 
 namespace brave {
 
-// Stores all given values in memory and persists in prefs on the fly.
+// Stores all given values in memory and persists them to a file on the fly.
+// The file is a header followed by fixed-size records sorted by histogram
+// name hash, and is rewritten atomically with writes coalesced by
+// |base::ImportantFileWriter|. Logs used to be persisted in local state, they
+// are moved to the file on load.
 // All logs (not only unsent are persistent), and all logs could be loaded
 // using |LoadPersistedUnsentLogs()|. We should fix this at some point since
 // for now persisted entries never expire.
-class BraveP3ALogStore : public metrics::LogStore {
+class BraveP3ALogStore : public metrics::LogStore,
+                         public base::ImportantFileWriter::DataSerializer {
  public:
   class Delegate {
    public:
@@ -32,11 +43,15 @@ class BraveP3ALogStore : public metrics::LogStore {
                                   uint64_t value) = 0;
     // Returns false if the metric is obsolete and should be cleaned up.
     virtual bool IsActualMetric(base::StringPiece histogram_name) const = 0;
+    // Returns the name of the metric with the given name hash, or an empty
+    // string if the metric is obsolete.
+    virtual base::StringPiece GetMetricName(uint64_t name_hash) const = 0;
     virtual ~Delegate() {}
   };
 
   BraveP3ALogStore(Delegate* delegate,
-                   PrefService* local_state);
+                   PrefService* local_state,
+                   const base::FilePath& path);
 
   // TODO(iefremov): Make parent destructor virtual?
   virtual ~BraveP3ALogStore();
@@ -63,10 +78,16 @@ class BraveP3ALogStore : public metrics::LogStore {
   // |TrimAndPersistUnsentLogs| should not be used, since we persist everything
   // on the fly.
   void TrimAndPersistUnsentLogs() override;
-  // Returns early if founds malformed persisted values.
+  // Moves the logs persisted in local state to the file if there are any,
+  // otherwise reads the file in the background. Values updated in the meantime
+  // take precedence over the persisted ones.
   void LoadPersistedUnsentLogs() override;
 
+  // base::ImportantFileWriter::DataSerializer:
+  bool SerializeData(std::string* data) override;
+
  private:
+  struct LogRecord;
   struct LogEntry {
     LogEntry() {}
     explicit LogEntry(size_t value) : value(value) {}
@@ -84,9 +105,26 @@ class BraveP3ALogStore : public metrics::LogStore {
     base::Time sent_timestamp;  // At the moment only for debugging purposes.
   };
 
+  // Returns early if founds malformed persisted values.
+  void LoadFromPrefs();
+  // Runs on |file_task_runner_|. Returns nothing if the file is malformed.
+  static std::vector<LogRecord> ReadLogRecords(const base::FilePath& path);
+  void OnLoadedFromFile(std::vector<LogRecord> records);
+  void ScheduleWrite();
+
   Delegate* const delegate_ = nullptr;  // Weak.
   PrefService* const local_state_ = nullptr;
 
+  scoped_refptr<base::SequencedTaskRunner> file_task_runner_;
+  base::ImportantFileWriter writer_;
+  // Writes are deferred until the persisted logs are loaded, so that they are
+  // not overwritten.
+  bool loaded_ = false;
+  // Changes made while the file was being read that the persisted logs must
+  // not revert.
+  bool reset_upload_stamps_while_loading_ = false;
+  base::flat_set<std::string> removed_while_loading_;
+
   // TODO(iefremov): Try to replace with base::StringPiece?
   base::flat_map<std::string, LogEntry> log_;
   base::flat_set<std::string> unsent_entries_;
@@ -97,6 +135,8 @@ class BraveP3ALogStore : public metrics::LogStore {
   // Not used for now.
   std::string staged_log_hash_;
   std::string staged_log_signature_;
+
+  base::WeakPtrFactory<BraveP3ALogStore> weak_factory_{this};
 };
 
 }  // namespace brave
@@ -0,0 +1,171 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/p3a/brave_p3a_log_store.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "base/containers/flat_set.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/metrics/metrics_hashes.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/test/task_environment.h"
+#include "base/values.h"
+#include "components/prefs/testing_pref_service.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+// npm run test -- brave_unit_tests --filter=BraveP3ALogStoreTest.*
+
+namespace brave {
+
+namespace {
+
+constexpr char kFirstMetric[] = "Brave.P3A.First";
+constexpr char kSecondMetric[] = "Brave.P3A.Second";
+
+class TestDelegate : public BraveP3ALogStore::Delegate {
+ public:
+  std::string Serialize(base::StringPiece histogram_name,
+                        uint64_t value) override {
+    return std::string(histogram_name) + ":" + base::NumberToString(value);
+  }
+
+  bool IsActualMetric(base::StringPiece histogram_name) const override {
+    return metrics_.contains(std::string(histogram_name));
+  }
+
+  base::StringPiece GetMetricName(uint64_t name_hash) const override {
+    for (const auto& name : metrics_) {
+      if (base::HashMetricName(name) == name_hash) {
+        return name;
+      }
+    }
+    return {};
+  }
+
+  base::flat_set<std::string> metrics_ = {kFirstMetric, kSecondMetric};
+};
+
+}  // namespace
+
+class BraveP3ALogStoreTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    path_ = temp_dir_.GetPath().AppendASCII("P3A Logs");
+    BraveP3ALogStore::RegisterPrefs(local_state_.registry());
+  }
+
+  std::unique_ptr<BraveP3ALogStore> CreateLoadedStore() {
+    auto store =
+        std::make_unique<BraveP3ALogStore>(&delegate_, &local_state_, path_);
+    store->LoadPersistedUnsentLogs();
+    task_environment_.RunUntilIdle();
+    return store;
+  }
+
+  // Stages and sends the next log, returns its contents.
+  std::string SendNextLog(BraveP3ALogStore* store) {
+    store->StageNextLog();
+    const std::string log = store->staged_log();
+    store->DiscardStagedLog();
+    return log;
+  }
+
+  void DestroyStore(std::unique_ptr<BraveP3ALogStore> store) {
+    store.reset();
+    task_environment_.RunUntilIdle();
+  }
+
+  base::test::TaskEnvironment task_environment_;
+  base::ScopedTempDir temp_dir_;
+  base::FilePath path_;
+  TestingPrefServiceSimple local_state_;
+  TestDelegate delegate_;
+};
+
+TEST_F(BraveP3ALogStoreTest, PersistsValuesAndSentState) {
+  auto store = CreateLoadedStore();
+  store->UpdateValue(kFirstMetric, 1);
+  store->UpdateValue(kSecondMetric, 2);
+  const std::string sent_log = SendNextLog(store.get());
+  DestroyStore(std::move(store));
+  EXPECT_TRUE(base::PathExists(path_));
+
+  store = CreateLoadedStore();
+  ASSERT_TRUE(store->has_unsent_logs());
+  const std::string unsent_log = SendNextLog(store.get());
+  EXPECT_NE(sent_log, unsent_log);
+  EXPECT_FALSE(store->has_unsent_logs());
+
+  // Once the stamps are reset both values are sent again.
+  store->ResetUploadStamps();
+  DestroyStore(std::move(store));
+  store = CreateLoadedStore();
+  const std::string log = SendNextLog(store.get());
+  EXPECT_TRUE(log == sent_log || log == unsent_log);
+  EXPECT_TRUE(store->has_unsent_logs());
+}
+
+TEST_F(BraveP3ALogStoreTest, MigratesFromPrefs) {
+  base::Value logs(base::Value::Type::DICTIONARY);
+  logs.SetPath({kFirstMetric, "value"}, base::Value("3"));
+  logs.SetPath({kFirstMetric, "sent"}, base::Value(false));
+  local_state_.Set("p3a.logs", logs);
+
+  auto store = CreateLoadedStore();
+  EXPECT_TRUE(local_state_.GetDictionary("p3a.logs")->DictEmpty());
+  EXPECT_TRUE(base::PathExists(path_));
+  DestroyStore(std::move(store));
+
+  store = CreateLoadedStore();
+  EXPECT_EQ(SendNextLog(store.get()), "Brave.P3A.First:3");
+  EXPECT_FALSE(store->has_unsent_logs());
+}
+
+TEST_F(BraveP3ALogStoreTest, DropsObsoleteMetrics) {
+  auto store = CreateLoadedStore();
+  store->UpdateValue(kFirstMetric, 1);
+  store->UpdateValue(kSecondMetric, 2);
+  DestroyStore(std::move(store));
+
+  delegate_.metrics_.erase(kSecondMetric);
+  store = CreateLoadedStore();
+  EXPECT_EQ(SendNextLog(store.get()), "Brave.P3A.First:1");
+  EXPECT_FALSE(store->has_unsent_logs());
+}
+
+TEST_F(BraveP3ALogStoreTest, KeepsValuesUpdatedWhileLoading) {
+  auto store = CreateLoadedStore();
+  store->UpdateValue(kFirstMetric, 1);
+  store->UpdateValue(kSecondMetric, 2);
+  DestroyStore(std::move(store));
+
+  store = std::make_unique<BraveP3ALogStore>(&delegate_, &local_state_, path_);
+  store->LoadPersistedUnsentLogs();
+  store->UpdateValue(kFirstMetric, 5);
+  store->RemoveValueIfExists(kSecondMetric);
+  task_environment_.RunUntilIdle();
+
+  EXPECT_EQ(SendNextLog(store.get()), "Brave.P3A.First:5");
+  EXPECT_FALSE(store->has_unsent_logs());
+}
+
+TEST_F(BraveP3ALogStoreTest, IgnoresMalformedFile) {
+  ASSERT_TRUE(base::WriteFile(path_, "malformed"));
+
+  auto store = CreateLoadedStore();
+  EXPECT_FALSE(store->has_unsent_logs());
+  store->UpdateValue(kFirstMetric, 1);
+  DestroyStore(std::move(store));
+
+  store = CreateLoadedStore();
+  EXPECT_EQ(SendNextLog(store.get()), "Brave.P3A.First:1");
+}
+
+}  // namespace brave
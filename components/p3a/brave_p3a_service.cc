@@ -8,6 +8,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "base/command_line.h"
 #include "base/i18n/timezone.h"
@@ -18,6 +19,7 @@
 #include "base/metrics/statistics_recorder.h"
 #include "base/no_destructor.h"
 #include "base/rand_util.h"
+#include "base/stl_util.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/task/post_task.h"
 #include "base/trace_event/trace_event.h"
@@ -45,11 +47,14 @@ namespace {
 // Receiving this value will effectively prevent the metric from transmission
 // to the backend. For now we consider this as a hack for p2a metrics, which
 // should be refactored in better times.
-constexpr int32_t kSuspendedMetricValue = INT_MAX - 1;
 constexpr uint64_t kSuspendedMetricBucket = INT_MAX - 1;
 
 constexpr char kLastRotationTimeStampPref[] = "p3a.last_rotation_timestamp";
 
+// The log store file, relative to the user data directory.
+constexpr base::FilePath::CharType kLogStoreFileName[] =
+    FILE_PATH_LITERAL("P3A Logs");
+
 constexpr char kP3AServerUrl[] = "https://p3a.brave.com/";
 constexpr char kP2AServerUrl[] = "https://p2a.brave.com/";
 
@@ -198,11 +203,14 @@ base::TimeDelta TimeDeltaTillMonday(base::Time time) {
 }  // namespace
 
 BraveP3AService::BraveP3AService(PrefService* local_state,
+                                 const base::FilePath& user_data_dir,
                                  std::string channel,
                                  std::string week_of_install)
     : local_state_(std::move(local_state)),
+      user_data_dir_(user_data_dir),
       channel_(std::move(channel)),
-      week_of_install_(week_of_install) {}
+      week_of_install_(week_of_install),
+      histogram_buffer_(base::size(kCollectedHistograms)) {}
 
 BraveP3AService::~BraveP3AService() = default;
 
@@ -217,12 +225,13 @@ void BraveP3AService::RegisterPrefs(PrefRegistrySimple* registry,
 }
 
 void BraveP3AService::InitCallbacks() {
-  for (const char* histogram_name : kCollectedHistograms) {
+  for (size_t i = 0; i < base::size(kCollectedHistograms); i++) {
     histogram_sample_callbacks_.push_back(
         std::make_unique<
             base::StatisticsRecorder::ScopedHistogramSampleObserver>(
-            histogram_name,
-            base::BindRepeating(&BraveP3AService::OnHistogramChanged, this)));
+            kCollectedHistograms[i],
+            base::BindRepeating(&BraveP3AService::OnHistogramChanged, this,
+                                i)));
   }
 }
 
@@ -247,7 +256,8 @@ void BraveP3AService::Init(
   InitPyxisMeta();
 
   // Init log store.
-  log_store_.reset(new BraveP3ALogStore(this, local_state_));
+  log_store_.reset(new BraveP3ALogStore(
+      this, local_state_, user_data_dir_.Append(kLogStoreFileName)));
   log_store_->LoadPersistedUnsentLogs();
   // Store values that were recorded between calling constructor and |Init()|.
   for (const auto& entry : histogram_values_) {
@@ -316,6 +326,19 @@ BraveP3AService::IsActualMetric(base::StringPiece histogram_name) const {
   return metric_names->contains(histogram_name);
 }
 
+base::StringPiece BraveP3AService::GetMetricName(uint64_t name_hash) const {
+  static const base::NoDestructor<base::flat_map<uint64_t, base::StringPiece>>
+      metric_names([] {
+        std::vector<std::pair<uint64_t, base::StringPiece>> names;
+        for (const char* name : kCollectedHistograms) {
+          names.emplace_back(base::HashMetricName(name), name);
+        }
+        return base::flat_map<uint64_t, base::StringPiece>(std::move(names));
+      }());
+  auto iter = metric_names->find(name_hash);
+  return iter != metric_names->end() ? iter->second : base::StringPiece();
+}
+
 void BraveP3AService::MaybeOverrideSettingsFromCommandLine() {
   base::CommandLine* cmdline = base::CommandLine::ForCurrentProcess();
 
@@ -407,7 +430,8 @@ void BraveP3AService::StartScheduledUpload() {
   }
 }
 
-void BraveP3AService::OnHistogramChanged(const char* histogram_name,
+void BraveP3AService::OnHistogramChanged(size_t histogram_index,
+                                         const char* histogram_name,
                                          uint64_t name_hash,
                                          base::HistogramBase::Sample sample) {
   std::unique_ptr<base::HistogramSamples> samples =
@@ -417,15 +441,14 @@ void BraveP3AService::OnHistogramChanged(const char* histogram_name,
   if (samples->Iterator()->Done())
     return;
 
-  // Shortcut for the special values, see |kSuspendedMetricValue|
+  // Shortcut for the special values, see |kSuspendedMetricBucket|
   // description for details.
   if (IsSuspendedMetric(histogram_name, sample)) {
-    base::PostTask(FROM_HERE, {content::BrowserThread::UI},
-                   base::BindOnce(&BraveP3AService::OnHistogramChangedOnUI,
-                                  this,
-                                  histogram_name,
-                                  kSuspendedMetricValue,
-                                  kSuspendedMetricBucket));
+    if (histogram_buffer_.Add(histogram_index, kSuspendedMetricBucket)) {
+      base::PostTask(FROM_HERE, {content::BrowserThread::UI},
+                     base::BindOnce(&BraveP3AService::OnHistogramsChangedOnUI,
+                                    this));
+    }
     return;
   }
 
@@ -454,24 +477,35 @@ void BraveP3AService::OnHistogramChanged(const char* histogram_name,
     bucket = DirectEncodingProtocol::Perturb(bucket_count, bucket);
   }
 
-  base::PostTask(FROM_HERE, {content::BrowserThread::UI},
-                 base::BindOnce(&BraveP3AService::OnHistogramChangedOnUI, this,
-                                histogram_name, sample, bucket));
-}
-
-void BraveP3AService::OnHistogramChangedOnUI(const char* histogram_name,
-                                             base::HistogramBase::Sample sample,
-                                             size_t bucket) {
   VLOG(2) << "BraveP3AService::OnHistogramChanged: histogram_name = "
           << histogram_name << " Sample = " << sample << " bucket = " << bucket;
-  if (!initialized_) {
-    // Will handle it later when ready.
-    histogram_values_[histogram_name] = bucket;
-  } else {
-    HandleHistogramChange(histogram_name, bucket);
+
+  // Only the first update of a batch needs a task, later ones are picked up
+  // by it.
+  if (histogram_buffer_.Add(histogram_index, bucket)) {
+    base::PostTask(FROM_HERE, {content::BrowserThread::UI},
+                   base::BindOnce(&BraveP3AService::OnHistogramsChangedOnUI,
+                                  this));
   }
 }
 
+void BraveP3AService::OnHistogramsChangedOnUI() {
+  for (const auto& update : histogram_buffer_.TakeUpdates()) {
+    const char* histogram_name = kCollectedHistograms[update.first];
+    const size_t bucket = update.second;
+    if (!initialized_) {
+      // Will handle it later when ready.
+      histogram_values_[histogram_name] = bucket;
+    } else {
+      HandleHistogramChange(histogram_name, bucket);
+    }
+  }
+
+  VLOG(2) << "BraveP3AService::OnHistogramsChangedOnUI: "
+          << histogram_buffer_.update_count() << " updates handled in "
+          << histogram_buffer_.batch_count() << " tasks";
+}
+
 void BraveP3AService::HandleHistogramChange(base::StringPiece histogram_name,
                                             size_t bucket) {
   if (IsSuspendedMetric(histogram_name, bucket)) {
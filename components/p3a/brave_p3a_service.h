@@ -11,11 +11,13 @@
 #include <vector>
 
 #include "base/containers/flat_map.h"
+#include "base/files/file_path.h"
 #include "base/memory/ref_counted.h"
 #include "base/metrics/histogram_base.h"
 #include "base/metrics/statistics_recorder.h"
 #include "base/timer/timer.h"
 #include "brave/components/brave_prochlo/brave_prochlo_message.h"
+#include "brave/components/p3a/brave_p3a_ingestion_buffer.h"
 #include "brave/components/p3a/brave_p3a_log_store.h"
 #include "url/gurl.h"
 
@@ -38,6 +40,7 @@ class BraveP3AService : public base::RefCountedThreadSafe<BraveP3AService>,
                         public BraveP3ALogStore::Delegate {
  public:
   BraveP3AService(PrefService* local_state,
+                  const base::FilePath& user_data_dir,
                   std::string channel,
                   std::string week_of_install);
 
@@ -58,6 +61,8 @@ class BraveP3AService : public base::RefCountedThreadSafe<BraveP3AService>,
   // May be accessed from multiple threads, so this is thread-safe.
   bool IsActualMetric(base::StringPiece histogram_name) const override;
 
+  base::StringPiece GetMetricName(uint64_t name_hash) const override;
+
  private:
   friend class base::RefCountedThreadSafe<BraveP3AService>;
   ~BraveP3AService() override;
@@ -72,14 +77,15 @@ class BraveP3AService : public base::RefCountedThreadSafe<BraveP3AService>,
   void StartScheduledUpload();
 
   // Invoked by callbacks registered by our service. Since these callbacks
-  // can fire on any thread, this method reposts everything to UI thread.
-  void OnHistogramChanged(const char* histogram_name,
+  // can fire on any thread, this method adds the new bucket to
+  // |histogram_buffer_| and posts a task to the UI thread to take it.
+  void OnHistogramChanged(size_t histogram_index,
+                          const char* histogram_name,
                           uint64_t name_hash,
                           base::HistogramBase::Sample sample);
 
-  void OnHistogramChangedOnUI(const char* histogram_name,
-                              base::HistogramBase::Sample sample,
-                              size_t bucket);
+  // Handles the updates buffered since the last call.
+  void OnHistogramsChangedOnUI();
 
   // Updates or removes a metric from the log.
   void HandleHistogramChange(base::StringPiece histogram_name, size_t bucket);
@@ -94,6 +100,7 @@ class BraveP3AService : public base::RefCountedThreadSafe<BraveP3AService>,
   // General prefs:
   bool initialized_ = false;
   PrefService* local_state_ = nullptr;
+  const base::FilePath user_data_dir_;
 
   const std::string channel_;
   const std::string week_of_install_;
@@ -112,6 +119,9 @@ class BraveP3AService : public base::RefCountedThreadSafe<BraveP3AService>,
   std::unique_ptr<BraveP3AUploader> uploader_;
   std::unique_ptr<BraveP3AScheduler> upload_scheduler_;
 
+  // Latest buckets of the collected histograms, not yet handled on UI thread.
+  BraveP3AIngestionBuffer histogram_buffer_;
+
   // Used to store histogram values that are produced between constructing
   // the service and its initialization.
   base::flat_map<base::StringPiece, size_t> histogram_values_;
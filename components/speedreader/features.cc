@@ -22,4 +22,8 @@ const base::Feature kSpeedreaderFeature {
 const base::Feature kSpeedreaderLegacyBackend{
     "Speedreader Legacy Backend", base::FEATURE_DISABLED_BY_DEFAULT};
 
+// Distill the response body as it's read rather than after it's fully loaded.
+const base::Feature kSpeedreaderStreamingDistillation{
+    "SpeedreaderStreamingDistillation", base::FEATURE_DISABLED_BY_DEFAULT};
+
 }  // namespace speedreader
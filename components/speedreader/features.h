@@ -13,6 +13,7 @@ struct Feature;
 namespace speedreader {
 extern const base::Feature kSpeedreaderFeature;
 extern const base::Feature kSpeedreaderLegacyBackend;
+extern const base::Feature kSpeedreaderStreamingDistillation;
 }  // namespace speedreader
 
 #endif  // BRAVE_COMPONENTS_SPEEDREADER_FEATURES_H_
@@ -5,6 +5,7 @@
 
 #include "brave/components/speedreader/speedreader_rewriter_service.h"
 
+#include <memory>
 #include <utility>
 
 #include "base/bind.h"
@@ -16,6 +17,7 @@
 #include "base/task/thread_pool.h"
 #include "brave/components/speedreader/features.h"
 #include "brave/components/speedreader/speedreader_component.h"
+#include "brave/components/speedreader/speedreader_streaming_rewriter.h"
 #include "brave/components/speedreader/speedreader_util.h"
 #include "components/grit/brave_components_resources.h"
 #include "ui/base/resource/resource_bundle.h"
@@ -116,6 +118,12 @@ std::unique_ptr<Rewriter> SpeedreaderRewriterService::MakeRewriter(
   return speedreader_->MakeRewriter(url.spec(), backend_);
 }
 
+std::unique_ptr<StreamingRewriter>
+SpeedreaderRewriterService::MakeStreamingRewriter(const GURL& url) {
+  return std::make_unique<StreamingRewriter>(speedreader_.get(), url.spec(),
+                                             backend_);
+}
+
 const std::string& SpeedreaderRewriterService::GetContentStylesheet() {
   return content_stylesheet_;
 }
@@ -22,6 +22,7 @@ class FilePath;
 namespace speedreader {
 class SpeedReader;
 class Rewriter;
+class StreamingRewriter;
 }  // namespace speedreader
 
 class GURL;
@@ -45,6 +46,7 @@ class SpeedreaderRewriterService : public SpeedreaderComponent::Observer {
   // The API
   bool IsWhitelisted(const GURL& url);
   std::unique_ptr<Rewriter> MakeRewriter(const GURL& url);
+  std::unique_ptr<StreamingRewriter> MakeStreamingRewriter(const GURL& url);
   const std::string& GetContentStylesheet();
 
  private:
@@ -0,0 +1,54 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/speedreader/speedreader_streaming_rewriter.h"
+
+namespace speedreader {
+
+StreamingRewriter::StreamingRewriter(SpeedReader* speedreader,
+                                     const std::string& url,
+                                     RewriterType rewriter_type)
+    : rewriter_(speedreader->MakeRewriter(url,
+                                          rewriter_type,
+                                          &StreamingRewriter::OnOutput,
+                                          this)) {
+  DETACH_FROM_SEQUENCE(sequence_checker_);
+}
+
+StreamingRewriter::StreamingRewriter() {
+  DETACH_FROM_SEQUENCE(sequence_checker_);
+}
+
+StreamingRewriter::~StreamingRewriter() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+}
+
+bool StreamingRewriter::Write(base::StringPiece chunk, std::string* output) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(output);
+  const int result = rewriter_->Write(chunk.data(), chunk.size());
+  output->append(pending_output_);
+  pending_output_.clear();
+  return result == 0;
+}
+
+bool StreamingRewriter::End(std::string* output) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(output);
+  const int result = rewriter_->End();
+  output->append(pending_output_);
+  pending_output_.clear();
+  return result == 0;
+}
+
+// static
+void StreamingRewriter::OnOutput(const char* chunk,
+                                 size_t chunk_len,
+                                 void* user_data) {
+  StreamingRewriter* self = static_cast<StreamingRewriter*>(user_data);
+  self->pending_output_.append(chunk, chunk_len);
+}
+
+}  // namespace speedreader
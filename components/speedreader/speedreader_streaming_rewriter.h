@@ -0,0 +1,57 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_SPEEDREADER_SPEEDREADER_STREAMING_REWRITER_H_
+#define BRAVE_COMPONENTS_SPEEDREADER_SPEEDREADER_STREAMING_REWRITER_H_
+
+#include <memory>
+#include <string>
+
+#include "base/sequence_checker.h"
+#include "base/strings/string_piece.h"
+#include "brave/components/speedreader/rust/ffi/speedreader.h"
+
+namespace speedreader {
+
+// Feeds a page to a streaming |Rewriter| chunk by chunk as it is read from the
+// network, handing back whatever output the rewriter produced for each chunk.
+// May be created on one sequence and then used on another, e.g. a background
+// sequence that keeps distilling off the loader's thread.
+class StreamingRewriter {
+ public:
+  StreamingRewriter(SpeedReader* speedreader,
+                    const std::string& url,
+                    RewriterType rewriter_type);
+  virtual ~StreamingRewriter();
+
+  StreamingRewriter(const StreamingRewriter&) = delete;
+  StreamingRewriter& operator=(const StreamingRewriter&) = delete;
+
+  // Writes |chunk| to the rewriter and appends any output produced while
+  // handling it to |output|. Returns false if the rewriter failed.
+  virtual bool Write(base::StringPiece chunk, std::string* output);
+
+  // Flushes the input written so far and appends the remaining output to
+  // |output|. Returns false if the rewriter failed.
+  virtual bool End(std::string* output);
+
+ protected:
+  // For fakes in tests, which override Write() and End().
+  StreamingRewriter();
+
+ private:
+  static void OnOutput(const char* chunk, size_t chunk_len, void* user_data);
+
+  // Output received from the rewriter and not yet handed back.
+  std::string pending_output_;
+  // Declared last so that it's destroyed before |pending_output_|.
+  std::unique_ptr<Rewriter> rewriter_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+};
+
+}  // namespace speedreader
+
+#endif  // BRAVE_COMPONENTS_SPEEDREADER_SPEEDREADER_STREAMING_REWRITER_H_
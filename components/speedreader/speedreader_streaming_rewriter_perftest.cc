@@ -0,0 +1,163 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/speedreader/speedreader_streaming_rewriter.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+// npm run test -- brave_perftests --filter=SpeedreaderStreamingPerfTest*
+
+namespace speedreader {
+
+namespace {
+
+constexpr int kWarmupRuns = 1;
+constexpr base::TimeDelta kTimeLimit = base::TimeDelta::FromSeconds(2);
+constexpr int kTimeCheckInterval = 1;
+
+// Matches the size of the reads from the response body data pipe
+constexpr size_t kChunkSize = 32768;
+
+constexpr char kTestURL[] = "https://www.example-news.com/2021/05/article.html";
+
+constexpr char kMetricTimeToFirstByte[] = ".time_to_first_byte";
+constexpr char kMetricDistillTime[] = ".distill_time";
+
+// A news article with navigation, sidebars and ad slots around
+// |paragraph_count| paragraphs of body text
+std::string BuildArticle(int paragraph_count) {
+  std::string page =
+      "<!DOCTYPE html><html><head><title>A long article</title>"
+      "<meta charset=\"utf-8\"><link rel=\"stylesheet\" href=\"/main.css\">"
+      "<script src=\"/app.js\"></script></head><body>"
+      "<header><nav><ul><li><a href=\"/\">Home</a></li>"
+      "<li><a href=\"/world\">World</a></li>"
+      "<li><a href=\"/tech\">Tech</a></li></ul></nav></header>"
+      "<aside class=\"sidebar\"><div class=\"ad-slot\">Advertisement</div>"
+      "<ul class=\"trending\"><li><a href=\"/a\">Trending story</a></li>"
+      "</ul></aside><main><article><h1>A long article</h1>"
+      "<p class=\"byline\">By A. Reporter</p>";
+
+  for (int i = 0; i < paragraph_count; i++) {
+    page += base::StringPrintf(
+        "<p>Paragraph %d of the article body. Lorem ipsum dolor sit amet, "
+        "consectetur adipiscing elit, sed do eiusmod tempor incididunt ut "
+        "labore et dolore magna aliqua. Ut enim ad minim veniam, quis nostrud "
+        "exercitation ullamco laboris nisi ut aliquip ex ea commodo consequat."
+        " <a href=\"/related/%d\">Related</a></p>",
+        i, i);
+    if (i % 20 == 19) {
+      page += "<div class=\"ad-slot\"><iframe src=\"https://ads.example/\">"
+              "</iframe></div>";
+    }
+  }
+
+  page +=
+      "</article></main><footer><p>Copyright</p>"
+      "<div class=\"comments\">Comments</div></footer></body></html>";
+  return page;
+}
+
+std::vector<base::StringPiece> SplitIntoChunks(const std::string& page) {
+  std::vector<base::StringPiece> chunks;
+  for (size_t i = 0; i < page.size(); i += kChunkSize) {
+    chunks.push_back(base::StringPiece(page).substr(i, kChunkSize));
+  }
+  return chunks;
+}
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story) {
+  perf_test::PerfResultReporter reporter("SpeedreaderStreaming.", story);
+  reporter.RegisterImportantMetric(kMetricTimeToFirstByte, "ms");
+  reporter.RegisterImportantMetric(kMetricDistillTime, "ms");
+  return reporter;
+}
+
+}  // namespace
+
+// Compares how long the distilled page takes to start reaching the renderer
+// once the last chunk of the body has been received. Buffered distillation
+// only starts then, while streaming distillation has already consumed every
+// earlier chunk as it arrived. The parameter is the number of paragraphs.
+class SpeedreaderStreamingPerfTest : public testing::TestWithParam<int> {
+ protected:
+  SpeedreaderStreamingPerfTest()
+      : page_(BuildArticle(GetParam())), chunks_(SplitIntoChunks(page_)) {}
+
+  ~SpeedreaderStreamingPerfTest() override = default;
+
+  std::string Story() const {
+    return "paragraphs_" + base::NumberToString(GetParam());
+  }
+
+  SpeedReader speedreader_;
+  const std::string page_;
+  const std::vector<base::StringPiece> chunks_;
+};
+
+TEST_P(SpeedreaderStreamingPerfTest, Buffered) {
+  base::TimeDelta time_to_first_byte;
+  base::LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    const base::TimeTicks body_received = base::TimeTicks::Now();
+    auto rewriter =
+        speedreader_.MakeRewriter(kTestURL, RewriterType::RewriterReadability);
+    ASSERT_EQ(0, rewriter->Write(page_.data(), page_.size()));
+    ASSERT_EQ(0, rewriter->End());
+    ASSERT_FALSE(rewriter->GetOutput().empty());
+    time_to_first_byte += base::TimeTicks::Now() - body_received;
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+
+  perf_test::PerfResultReporter reporter = SetUpReporter("buffered_" + Story());
+  reporter.AddResult(kMetricTimeToFirstByte,
+                     time_to_first_byte.InMillisecondsF() / timer.NumLaps());
+  reporter.AddResult(kMetricDistillTime, timer.TimePerLap().InMillisecondsF());
+}
+
+TEST_P(SpeedreaderStreamingPerfTest, Streaming) {
+  base::TimeDelta time_to_first_byte;
+  base::LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    StreamingRewriter rewriter(&speedreader_, kTestURL,
+                               RewriterType::RewriterReadability);
+    std::string output;
+    // Chunks received while the rest of the body is still downloading.
+    for (size_t i = 0; i + 1 < chunks_.size(); i++) {
+      ASSERT_TRUE(rewriter.Write(chunks_[i], &output));
+    }
+
+    // The readability backend only produces output once the input ends, so
+    // this covers the last chunk and the end of the input.
+    const base::TimeTicks body_received = base::TimeTicks::Now();
+    ASSERT_TRUE(rewriter.Write(chunks_.back(), &output));
+    ASSERT_TRUE(rewriter.End(&output));
+    time_to_first_byte += base::TimeTicks::Now() - body_received;
+    ASSERT_FALSE(output.empty());
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+
+  perf_test::PerfResultReporter reporter =
+      SetUpReporter("streaming_" + Story());
+  reporter.AddResult(kMetricTimeToFirstByte,
+                     time_to_first_byte.InMillisecondsF() / timer.NumLaps());
+  reporter.AddResult(kMetricDistillTime, timer.TimePerLap().InMillisecondsF());
+}
+
+INSTANTIATE_TEST_SUITE_P(All,
+                         SpeedreaderStreamingPerfTest,
+                         testing::Values(200, 1000, 5000));
+
+}  // namespace speedreader
@@ -0,0 +1,93 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/speedreader/speedreader_streaming_rewriter.h"
+
+#include <cstring>
+#include <string>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+constexpr char kTestConfig[] = R"(
+[
+    {
+        "domain": "example.com",
+        "url_rules": [
+            "||example.com/*/article/"
+        ],
+        "declarative_rewrite": {
+            "main_content": [
+                ".article-body"
+            ],
+            "main_content_cleanup": [],
+            "delazify": false,
+            "fix_embeds": false,
+            "content_script": null,
+            "preprocess": []
+        }
+    }
+]
+)";
+
+constexpr char kTestURL[] = "https://example.com/news/article/index.html";
+
+}  // namespace
+
+namespace speedreader {
+
+TEST(SpeedreaderStreamingRewriterTest, WritesInChunks) {
+  SpeedReader speedreader;
+  ASSERT_TRUE(speedreader.deserialize(kTestConfig, strlen(kTestConfig)));
+  StreamingRewriter rewriter(&speedreader, kTestURL,
+                             RewriterType::RewriterUnknown);
+
+  std::string output;
+  EXPECT_TRUE(rewriter.Write("<html><div class=\"article-body\">", &output));
+  EXPECT_TRUE(rewriter.Write("hello world</div></html>", &output));
+  EXPECT_TRUE(rewriter.End(&output));
+  EXPECT_EQ("<html><div class=\"article-body\">hello world</div></html>",
+            output);
+}
+
+TEST(SpeedreaderStreamingRewriterTest, ChunkedOutputMatchesBuffered) {
+  SpeedReader speedreader;
+  ASSERT_TRUE(speedreader.deserialize(kTestConfig, strlen(kTestConfig)));
+
+  const std::string page =
+      "<html><head><title>Title</title></head><body>"
+      "<div class=\"nav\">navigation</div>"
+      "<div class=\"article-body\"><p>first paragraph</p>"
+      "<p>second paragraph</p></div>"
+      "<div class=\"footer\">footer</div></body></html>";
+
+  auto buffered = speedreader.MakeRewriter(kTestURL);
+  ASSERT_EQ(0, buffered->Write(page.data(), page.size()));
+  ASSERT_EQ(0, buffered->End());
+
+  StreamingRewriter rewriter(&speedreader, kTestURL,
+                             RewriterType::RewriterUnknown);
+  std::string output;
+  for (size_t i = 0; i < page.size(); i += 7) {
+    EXPECT_TRUE(rewriter.Write(base::StringPiece(page).substr(i, 7), &output));
+  }
+  EXPECT_TRUE(rewriter.End(&output));
+  EXPECT_EQ(buffered->GetOutput(), output);
+}
+
+TEST(SpeedreaderStreamingRewriterTest, WriteAfterEndFails) {
+  SpeedReader speedreader;
+  ASSERT_TRUE(speedreader.deserialize(kTestConfig, strlen(kTestConfig)));
+  StreamingRewriter rewriter(&speedreader, kTestURL,
+                             RewriterType::RewriterUnknown);
+
+  std::string output;
+  EXPECT_TRUE(rewriter.End(&output));
+  EXPECT_FALSE(rewriter.Write("hello", &output));
+  EXPECT_FALSE(rewriter.End(&output));
+}
+
+}  // namespace speedreader
@@ -10,13 +10,18 @@
 #include <utility>
 
 #include "base/bind.h"
+#include "base/feature_list.h"
 #include "base/metrics/histogram_macros.h"
+#include "base/no_destructor.h"
 #include "base/task/post_task.h"
 #include "base/task/thread_pool.h"
+#include "brave/components/speedreader/features.h"
 #include "brave/components/speedreader/rust/ffi/speedreader.h"
 #include "brave/components/speedreader/speedreader_rewriter_service.h"
+#include "brave/components/speedreader/speedreader_streaming_rewriter.h"
 #include "brave/components/speedreader/speedreader_throttle.h"
 #include "mojo/public/cpp/bindings/self_owned_receiver.h"
+#include "net/base/net_errors.h"
 #include "services/network/public/mojom/url_response_head.mojom.h"
 
 namespace speedreader {
@@ -25,8 +30,40 @@ namespace {
 
 constexpr uint32_t kReadBufferSize = 32768;
 
+// TODO(brave-browser/issues/10372): would be better to pass explicit signal
+// back from rewriter to indicate if content was found
+constexpr size_t kMinDistilledSize = 1024;
+
+absl::optional<std::string> WriteToRewriter(StreamingRewriter* rewriter,
+                                            std::string chunk) {
+  std::string output;
+  if (!rewriter->Write(chunk, &output))
+    return absl::nullopt;
+  return output;
+}
+
+absl::optional<std::string> EndRewriter(StreamingRewriter* rewriter) {
+  std::string output;
+  if (!rewriter->End(&output))
+    return absl::nullopt;
+  return output;
+}
+
+SpeedReaderURLLoader::StreamingRewriterFactory&
+GetStreamingRewriterFactoryForTesting() {
+  static base::NoDestructor<SpeedReaderURLLoader::StreamingRewriterFactory>
+      factory;
+  return *factory;
+}
+
 }  // namespace
 
+// static
+void SpeedReaderURLLoader::SetStreamingRewriterFactoryForTesting(
+    StreamingRewriterFactory factory) {
+  GetStreamingRewriterFactoryForTesting() = std::move(factory);
+}
+
 // static
 std::tuple<mojo::PendingRemote<network::mojom::URLLoader>,
            mojo::PendingReceiver<network::mojom::URLLoaderClient>,
@@ -69,6 +106,7 @@ SpeedReaderURLLoader::SpeedReaderURLLoader(
       body_producer_watcher_(FROM_HERE,
                              mojo::SimpleWatcher::ArmingPolicy::MANUAL,
                              std::move(task_runner)),
+      streaming_rewriter_(nullptr, base::OnTaskRunnerDeleter(nullptr)),
       rewriter_service_(rewriter_service) {}
 
 SpeedReaderURLLoader::~SpeedReaderURLLoader() = default;
@@ -123,6 +161,7 @@ void SpeedReaderURLLoader::OnStartLoadingResponseBody(
   VLOG(2) << __func__ << " " << response_url_;
   state_ = State::kLoading;
   body_consumer_handle_ = std::move(body);
+  MaybeStartStreamingDistillation();
   body_consumer_watcher_.Watch(
       body_consumer_handle_.get(),
       MOJO_HANDLE_SIGNAL_READABLE | MOJO_HANDLE_SIGNAL_PEER_CLOSED,
@@ -192,6 +231,11 @@ void SpeedReaderURLLoader::ResumeReadingBodyFromNet() {
 }
 
 void SpeedReaderURLLoader::OnBodyReadable(MojoResult) {
+  if (streaming_rewriter_) {
+    StreamBodyToRewriter();
+    return;
+  }
+
   DCHECK_EQ(State::kLoading, state_);
 
   size_t start_size = buffered_body_.size();
@@ -217,10 +261,6 @@ void SpeedReaderURLLoader::OnBodyReadable(MojoResult) {
 
   DCHECK_EQ(MOJO_RESULT_OK, result);
   buffered_body_.resize(start_size + read_bytes);
-  // TODO(iefremov): We actually can partially |pumpContent| to speedreader,
-  // but skipping it for now to simplify things. Pumping is not free in terms
-  // of CPU ticks, so we will have to keep alive speedreader instance on another
-  // thread.
 
   body_consumer_watcher_.ArmOrNotify();
 }
@@ -229,11 +269,141 @@ void SpeedReaderURLLoader::OnBodyWritable(MojoResult r) {
   DCHECK_EQ(State::kSending, state_);
   if (bytes_remaining_in_buffer_ > 0) {
     SendReceivedBodyToClient();
+  } else if (streaming_rewriter_ && !distill_complete_) {
+    // Everything distilled so far has been sent, wait for more output.
+    buffered_body_.clear();
+    waiting_for_distilled_output_ = true;
   } else {
     CompleteSending();
   }
 }
 
+void SpeedReaderURLLoader::MaybeStartStreamingDistillation() {
+  const auto& factory_for_testing = GetStreamingRewriterFactoryForTesting();
+  if ((!rewriter_service_ && !factory_for_testing) ||
+      !base::FeatureList::IsEnabled(kSpeedreaderStreamingDistillation)) {
+    return;
+  }
+
+  // Distilling is not free in terms of CPU ticks, so keep the rewriter on
+  // another sequence and pump the body to it as it's read.
+  distill_task_runner_ = base::ThreadPool::CreateSequencedTaskRunner(
+      {base::TaskPriority::USER_BLOCKING});
+  std::unique_ptr<StreamingRewriter> rewriter =
+      factory_for_testing
+          ? factory_for_testing.Run()
+          : rewriter_service_->MakeStreamingRewriter(response_url_);
+  streaming_rewriter_ =
+      std::unique_ptr<StreamingRewriter, base::OnTaskRunnerDeleter>(
+          rewriter.release(), base::OnTaskRunnerDeleter(distill_task_runner_));
+}
+
+void SpeedReaderURLLoader::StreamBodyToRewriter() {
+  DCHECK(state_ == State::kLoading || state_ == State::kSending);
+
+  std::string chunk(kReadBufferSize, '\0');
+  uint32_t read_bytes = kReadBufferSize;
+  MojoResult result = body_consumer_handle_->ReadData(
+      &chunk[0], &read_bytes, MOJO_READ_DATA_FLAG_NONE);
+  switch (result) {
+    case MOJO_RESULT_OK:
+      break;
+    case MOJO_RESULT_FAILED_PRECONDITION:
+      // Reading is finished.
+      distill_task_runner_->PostTaskAndReplyWithResult(
+          FROM_HERE,
+          base::BindOnce(&EndRewriter,
+                         base::Unretained(streaming_rewriter_.get())),
+          base::BindOnce(&SpeedReaderURLLoader::OnDistilledOutput,
+                         weak_factory_.GetWeakPtr(), true));
+      return;
+    case MOJO_RESULT_SHOULD_WAIT:
+      body_consumer_watcher_.ArmOrNotify();
+      return;
+    default:
+      NOTREACHED();
+      return;
+  }
+
+  DCHECK_EQ(MOJO_RESULT_OK, result);
+  chunk.resize(read_bytes);
+  // Keep the original body until the distilled output is committed to, so
+  // that it can be sent untouched if distilling fails or finds no content.
+  if (state_ == State::kLoading)
+    buffered_body_.append(chunk);
+
+  // |streaming_rewriter_| is deleted on |distill_task_runner_|, after any
+  // task posted here.
+  distill_task_runner_->PostTaskAndReplyWithResult(
+      FROM_HERE,
+      base::BindOnce(&WriteToRewriter,
+                     base::Unretained(streaming_rewriter_.get()),
+                     std::move(chunk)),
+      base::BindOnce(&SpeedReaderURLLoader::OnDistilledOutput,
+                     weak_factory_.GetWeakPtr(), false));
+
+  body_consumer_watcher_.ArmOrNotify();
+}
+
+void SpeedReaderURLLoader::OnDistilledOutput(
+    bool is_last,
+    absl::optional<std::string> output) {
+  if (state_ != State::kLoading && state_ != State::kSending)
+    return;
+
+  if (!output)
+    distill_failed_ = true;
+
+  if (state_ == State::kLoading) {
+    if (is_last)
+      distill_complete_ = true;
+
+    if (distill_failed_) {
+      // Send the original body once it has been read completely.
+      if (is_last)
+        CompleteLoading(std::move(buffered_body_));
+      return;
+    }
+
+    distilled_body_.append(*output);
+    if (distilled_body_.size() >= kMinDistilledSize) {
+      // Commit to the distilled page, the original body is not needed
+      // anymore.
+      buffered_body_.clear();
+      CompleteLoading(
+          (rewriter_service_ ? rewriter_service_->GetContentStylesheet()
+                             : std::string()) +
+          distilled_body_);
+      distilled_body_.clear();
+    } else if (is_last) {
+      CompleteLoading(std::move(buffered_body_));
+    }
+    return;
+  }
+
+  DCHECK_EQ(State::kSending, state_);
+  if (distill_failed_) {
+    // Part of the distilled page has already been sent, so the original body
+    // can't be sent instead. Fail the load rather than finish it with a
+    // truncated page.
+    VLOG(1) << __func__ << " distilling failed for " << response_url_;
+    destination_url_loader_client_->OnComplete(
+        network::URLLoaderCompletionStatus(net::ERR_FAILED));
+    Abort();
+    return;
+  }
+
+  buffered_body_.append(*output);
+  bytes_remaining_in_buffer_ += output->size();
+  if (is_last)
+    distill_complete_ = true;
+
+  if (waiting_for_distilled_output_) {
+    waiting_for_distilled_output_ = false;
+    body_producer_watcher_.ArmOrNotify();
+  }
+}
+
 void SpeedReaderURLLoader::MaybeLaunchSpeedreader() {
   DCHECK_EQ(State::kLoading, state_);
   if (!throttle_ || !rewriter_service_) {
@@ -261,10 +431,7 @@ void SpeedReaderURLLoader::MaybeLaunchSpeedreader() {
               rewriter->End();
               const std::string& transformed = rewriter->GetOutput();
 
-              // TODO(brave-browser/issues/10372): would be better to pass
-              // explicit signal back from rewriter to indicate if content was
-              // found
-              if (transformed.length() < 1024) {
+              if (transformed.length() < kMinDistilledSize) {
                 return data;
               }
 
@@ -332,6 +499,7 @@ void SpeedReaderURLLoader::CompleteSending() {
   body_producer_watcher_.Cancel();
   body_consumer_handle_.reset();
   body_producer_handle_.reset();
+  streaming_rewriter_.reset();
 }
 
 void SpeedReaderURLLoader::SendReceivedBodyToClient() {
@@ -370,6 +538,7 @@ void SpeedReaderURLLoader::Abort() {
   source_url_loader_.reset();
   source_url_client_receiver_.reset();
   destination_url_loader_client_.reset();
+  streaming_rewriter_.reset();
   // |this| should be removed since the owner will destroy |this| or the owner
   // has already been destroyed by some reason.
 }
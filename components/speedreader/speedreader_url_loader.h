@@ -6,6 +6,7 @@
 #ifndef BRAVE_COMPONENTS_SPEEDREADER_SPEEDREADER_URL_LOADER_H_
 #define BRAVE_COMPONENTS_SPEEDREADER_SPEEDREADER_URL_LOADER_H_
 
+#include <memory>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -14,6 +15,7 @@
 #include "base/memory/ref_counted.h"
 #include "base/memory/weak_ptr.h"
 #include "base/strings/string_piece.h"
+#include "base/task/sequenced_task_runner.h"
 #include "mojo/public/cpp/bindings/pending_receiver.h"
 #include "mojo/public/cpp/bindings/pending_remote.h"
 #include "mojo/public/cpp/bindings/receiver.h"
@@ -28,6 +30,7 @@ namespace speedreader {
 
 class SpeedReaderThrottle;
 class SpeedreaderRewriterService;
+class StreamingRewriter;
 
 // Loads the whole response body and tries to Speedreader-distill it.
 // Cargoculted from |`SniffingURLLoader|.
@@ -44,8 +47,14 @@ class SpeedreaderRewriterService;
 //            done, this loader will dispatch queued messages like
 //            OnStartLoadingResponseBody() to the destination
 //            loader client, and then the state is changed to kSending.
+//            With |kSpeedreaderStreamingDistillation| each chunk of the body
+//            is distilled as it's received instead, and the state changes to
+//            kSending as soon as enough distilled output is available.
 // kSending: Receives the body and sends it to the destination loader client.
-//           The state changes to kCompleted after all data is sent.
+//           When streaming, distilled output keeps being appended while the
+//           rest of the body is distilled. The state changes to kCompleted
+//           after all data is sent, or to kAborted with net::ERR_FAILED if
+//           distilling fails after the distilled page has started.
 // kCompleted: All data has been sent to the destination loader.
 // kAborted: Unexpected behavior happens. Watchers, pipes and the binding from
 //           the source loader to |this| are stopped. All incoming messages from
@@ -58,6 +67,15 @@ class SpeedReaderURLLoader : public network::mojom::URLLoaderClient,
   SpeedReaderURLLoader(const SpeedReaderURLLoader&) = delete;
   SpeedReaderURLLoader& operator=(const SpeedReaderURLLoader&) = delete;
 
+  using StreamingRewriterFactory =
+      base::RepeatingCallback<std::unique_ptr<StreamingRewriter>()>;
+
+  // Makes streaming distillation use the rewriters returned by |factory|
+  // instead of the ones from the rewriter service. Pass a null callback to
+  // restore the default.
+  static void SetStreamingRewriterFactoryForTesting(
+      StreamingRewriterFactory factory);
+
   // Start waiting for the body.
   void Start(
       mojo::PendingRemote<network::mojom::URLLoader> source_url_loader_remote,
@@ -115,6 +133,11 @@ class SpeedReaderURLLoader : public network::mojom::URLLoaderClient,
   void OnBodyWritable(MojoResult);
   void MaybeLaunchSpeedreader();
 
+  // Streaming distillation, see |kSpeedreaderStreamingDistillation|.
+  void MaybeStartStreamingDistillation();
+  void StreamBodyToRewriter();
+  void OnDistilledOutput(bool is_last, absl::optional<std::string> output);
+
   // Gets either distilled or untouched body.
   void CompleteLoading(std::string body);
   void CompleteSending();
@@ -141,7 +164,20 @@ class SpeedReaderURLLoader : public network::mojom::URLLoaderClient,
 
   // Note that this could be replaced by a distilled version.
   std::string buffered_body_;
-  size_t bytes_remaining_in_buffer_;
+  size_t bytes_remaining_in_buffer_ = 0;
+
+  // Set when the body is distilled as it's read. The rewriter lives on
+  // |distill_task_runner_| and is deleted there.
+  scoped_refptr<base::SequencedTaskRunner> distill_task_runner_;
+  std::unique_ptr<StreamingRewriter, base::OnTaskRunnerDeleter>
+      streaming_rewriter_;
+  // Distilled output held back until it's large enough to commit to sending
+  // it instead of the original body.
+  std::string distilled_body_;
+  bool distill_failed_ = false;
+  bool distill_complete_ = false;
+  // Whether the producer watcher is disarmed while waiting for more output.
+  bool waiting_for_distilled_output_ = false;
 
   mojo::ScopedDataPipeConsumerHandle body_consumer_handle_;
   mojo::ScopedDataPipeProducerHandle body_producer_handle_;
@@ -0,0 +1,264 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/speedreader/speedreader_url_loader.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/test/scoped_feature_list.h"
+#include "base/test/task_environment.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "brave/components/speedreader/features.h"
+#include "brave/components/speedreader/speedreader_streaming_rewriter.h"
+#include "brave/components/speedreader/speedreader_throttle.h"
+#include "mojo/public/cpp/bindings/pending_receiver.h"
+#include "mojo/public/cpp/bindings/pending_remote.h"
+#include "mojo/public/cpp/bindings/remote.h"
+#include "mojo/public/cpp/system/data_pipe_utils.h"
+#include "net/base/net_errors.h"
+#include "services/network/public/cpp/url_loader_completion_status.h"
+#include "services/network/public/mojom/url_response_head.mojom.h"
+#include "services/network/test/test_url_loader_client.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/blink/public/common/loader/url_loader_throttle.h"
+#include "url/gurl.h"
+
+// npm run test -- brave_unit_tests --filter='SpeedReaderURLLoaderTest.*'
+
+namespace speedreader {
+
+namespace {
+
+constexpr char kTestURL[] = "https://example.com/news/article/index.html";
+
+// Hands back its input as the distilled output, or nothing at all when
+// |finds_content| is false, and fails once more than |fail_after| bytes have
+// been written.
+class FakeStreamingRewriter : public StreamingRewriter {
+ public:
+  FakeStreamingRewriter(bool finds_content, size_t fail_after)
+      : finds_content_(finds_content), fail_after_(fail_after) {}
+  ~FakeStreamingRewriter() override = default;
+
+  bool Write(base::StringPiece chunk, std::string* output) override {
+    written_ += chunk.size();
+    if (written_ > fail_after_)
+      return false;
+    if (finds_content_)
+      output->append(chunk.data(), chunk.size());
+    return true;
+  }
+
+  bool End(std::string* output) override { return written_ <= fail_after_; }
+
+ private:
+  const bool finds_content_;
+  const size_t fail_after_;
+  size_t written_ = 0;
+};
+
+// Cargoculted from the MimeSniffingThrottle tests.
+class MockDelegate : public blink::URLLoaderThrottle::Delegate {
+ public:
+  // blink::URLLoaderThrottle::Delegate:
+  void CancelWithError(int error_code,
+                       base::StringPiece custom_reason) override {
+    NOTREACHED();
+  }
+  void Resume() override { is_resumed_ = true; }
+  void InterceptResponse(
+      mojo::PendingRemote<network::mojom::URLLoader> new_loader,
+      mojo::PendingReceiver<network::mojom::URLLoaderClient>
+          new_client_receiver,
+      mojo::PendingRemote<network::mojom::URLLoader>* original_loader,
+      mojo::PendingReceiver<network::mojom::URLLoaderClient>*
+          original_client_receiver) override {
+    destination_loader_remote_.Bind(std::move(new_loader));
+    ASSERT_TRUE(mojo::FusePipes(
+        std::move(new_client_receiver),
+        mojo::PendingRemote<network::mojom::URLLoaderClient>(
+            destination_loader_client_.CreateRemote())));
+    pending_receiver_ = original_loader->InitWithNewPipeAndPassReceiver();
+    *original_client_receiver =
+        source_loader_client_remote_.BindNewPipeAndPassReceiver();
+  }
+
+  // Starts sending the body from the source loader, returning the producer
+  // end of the body pipe.
+  mojo::ScopedDataPipeProducerHandle StartLoadingResponseBody() {
+    mojo::ScopedDataPipeProducerHandle producer;
+    mojo::ScopedDataPipeConsumerHandle consumer;
+    EXPECT_EQ(MOJO_RESULT_OK,
+              mojo::CreateDataPipe(nullptr, producer, consumer));
+    source_loader_client_remote_->OnStartLoadingResponseBody(
+        std::move(consumer));
+    return producer;
+  }
+
+  void CompleteResponse() {
+    source_loader_client_remote_->OnComplete(
+        network::URLLoaderCompletionStatus(net::OK));
+  }
+
+  std::string ReadResponseBody() {
+    std::string body;
+    EXPECT_TRUE(mojo::BlockingCopyToString(
+        destination_loader_client_.response_body_release(), &body));
+    return body;
+  }
+
+  bool is_resumed() const { return is_resumed_; }
+  network::TestURLLoaderClient* destination_loader_client() {
+    return &destination_loader_client_;
+  }
+
+ private:
+  bool is_resumed_ = false;
+
+  // A pair of a loader and a loader client for destination of the response.
+  mojo::Remote<network::mojom::URLLoader> destination_loader_remote_;
+  network::TestURLLoaderClient destination_loader_client_;
+
+  // A pair of a receiver and a remote for source of the response.
+  mojo::PendingReceiver<network::mojom::URLLoader> pending_receiver_;
+  mojo::Remote<network::mojom::URLLoaderClient> source_loader_client_remote_;
+};
+
+}  // namespace
+
+class SpeedReaderURLLoaderTest : public testing::Test {
+ public:
+  SpeedReaderURLLoaderTest() {
+    feature_list_.InitAndEnableFeature(kSpeedreaderStreamingDistillation);
+  }
+  ~SpeedReaderURLLoaderTest() override {
+    SpeedReaderURLLoader::SetStreamingRewriterFactoryForTesting(
+        SpeedReaderURLLoader::StreamingRewriterFactory());
+  }
+
+ protected:
+  // Starts a throttled load distilled by fake rewriters.
+  void StartLoad(bool finds_content, size_t fail_after) {
+    SpeedReaderURLLoader::SetStreamingRewriterFactoryForTesting(
+        base::BindRepeating(
+            [](bool finds_content,
+               size_t fail_after) -> std::unique_ptr<StreamingRewriter> {
+              return std::make_unique<FakeStreamingRewriter>(finds_content,
+                                                             fail_after);
+            },
+            finds_content, fail_after));
+
+    throttle_ = std::make_unique<SpeedReaderThrottle>(
+        nullptr, base::ThreadTaskRunnerHandle::Get());
+    throttle_->set_delegate(&delegate_);
+
+    auto response_head = network::mojom::URLResponseHead::New();
+    bool defer = false;
+    throttle_->WillProcessResponse(GURL(kTestURL), response_head.get(),
+                                   &defer);
+    EXPECT_TRUE(defer);
+  }
+
+  base::test::TaskEnvironment task_environment_;
+  base::test::ScopedFeatureList feature_list_;
+  MockDelegate delegate_;
+  std::unique_ptr<SpeedReaderThrottle> throttle_;
+};
+
+TEST_F(SpeedReaderURLLoaderTest, CommitsOnceDistilledOutputIsLargeEnough) {
+  StartLoad(true, std::string::npos);
+  auto* client = delegate_.destination_loader_client();
+
+  mojo::ScopedDataPipeProducerHandle producer =
+      delegate_.StartLoadingResponseBody();
+  const std::string small(512, 'a');
+  ASSERT_TRUE(mojo::BlockingCopyFromString(small, producer));
+  task_environment_.RunUntilIdle();
+
+  // Not enough distilled output to commit to yet
+  EXPECT_FALSE(delegate_.is_resumed());
+  EXPECT_FALSE(client->response_body().is_valid());
+
+  const std::string rest(1024, 'b');
+  ASSERT_TRUE(mojo::BlockingCopyFromString(rest, producer));
+  task_environment_.RunUntilIdle();
+
+  // The distilled page starts before the whole body has been read
+  EXPECT_TRUE(delegate_.is_resumed());
+  EXPECT_TRUE(client->response_body().is_valid());
+  EXPECT_FALSE(client->has_received_completion());
+
+  const std::string tail(256, 'c');
+  ASSERT_TRUE(mojo::BlockingCopyFromString(tail, producer));
+  producer.reset();
+  delegate_.CompleteResponse();
+  client->RunUntilComplete();
+
+  EXPECT_EQ(net::OK, client->completion_status().error_code);
+  EXPECT_EQ(small + rest + tail, delegate_.ReadResponseBody());
+}
+
+TEST_F(SpeedReaderURLLoaderTest, SendsOriginalBodyWhenDistillingFails) {
+  StartLoad(true, 0);
+  auto* client = delegate_.destination_loader_client();
+
+  mojo::ScopedDataPipeProducerHandle producer =
+      delegate_.StartLoadingResponseBody();
+  const std::string body(4096, 'a');
+  ASSERT_TRUE(mojo::BlockingCopyFromString(body, producer));
+  task_environment_.RunUntilIdle();
+
+  // The original body is only sent once it has been read completely
+  EXPECT_FALSE(delegate_.is_resumed());
+
+  producer.reset();
+  delegate_.CompleteResponse();
+  client->RunUntilComplete();
+
+  EXPECT_TRUE(delegate_.is_resumed());
+  EXPECT_EQ(net::OK, client->completion_status().error_code);
+  EXPECT_EQ(body, delegate_.ReadResponseBody());
+}
+
+TEST_F(SpeedReaderURLLoaderTest, SendsOriginalBodyWhenNoContentIsFound) {
+  StartLoad(false, std::string::npos);
+  auto* client = delegate_.destination_loader_client();
+
+  mojo::ScopedDataPipeProducerHandle producer =
+      delegate_.StartLoadingResponseBody();
+  const std::string body(4096, 'a');
+  ASSERT_TRUE(mojo::BlockingCopyFromString(body, producer));
+  producer.reset();
+  delegate_.CompleteResponse();
+  client->RunUntilComplete();
+
+  EXPECT_TRUE(delegate_.is_resumed());
+  EXPECT_EQ(net::OK, client->completion_status().error_code);
+  EXPECT_EQ(body, delegate_.ReadResponseBody());
+}
+
+TEST_F(SpeedReaderURLLoaderTest, FailsLoadWhenDistillingFailsAfterCommit) {
+  StartLoad(true, 2048);
+  auto* client = delegate_.destination_loader_client();
+
+  mojo::ScopedDataPipeProducerHandle producer =
+      delegate_.StartLoadingResponseBody();
+  ASSERT_TRUE(mojo::BlockingCopyFromString(std::string(2048, 'a'), producer));
+  task_environment_.RunUntilIdle();
+  ASSERT_TRUE(delegate_.is_resumed());
+  ASSERT_TRUE(client->response_body().is_valid());
+
+  // Part of the distilled page has been sent, so the original body can't be
+  // sent instead
+  ASSERT_TRUE(mojo::BlockingCopyFromString(std::string(1024, 'b'), producer));
+  client->RunUntilComplete();
+
+  EXPECT_EQ(net::ERR_FAILED, client->completion_status().error_code);
+}
+
+}  // namespace speedreader